@@ -1,4 +1,4 @@
-#include "Board.h" 
+#include "Board.h"
 #include <iostream>
 #include <vector>
 
@@ -7,32 +7,85 @@ using namespace std;
 // O conteúdo da classe BOARD { ... } FOI REMOVIDO daqui.
 // Apenas as implementações dos métodos são mantidas.
 
+// Powers of 3 used to update the board code, one per cell (3^63 overflows, but codes only matter up to 40 cells)
+static constexpr array<uint64_t, 64> build_pow3() {
+    array<uint64_t, 64> pow3{};
+    pow3[0] = 1;
+    for(int i = 1; i < 64; i++)
+        pow3[i] = pow3[i-1] * 3;
+    return pow3;
+}
+static constexpr array<uint64_t, 64> POW3 = build_pow3();
+
+// Base-3 digit of each symbol
+static constexpr int cell_digit(char symbol) {
+    return symbol == 'X' ? 1 : symbol == 'O' ? 2 : 0;
+}
+
 /**
- * @brief Constructs an empty Tic-Tac-Toe board.
+ * @brief Builds the terminal status of every base-3 code of the 3x3 board at compile time.
+ * Bits 0-1 hold the status and bits 4-7 the number of empty cells.
+ * Positions where both players have a line never happen in a game and are marked as X wins.
  */
-BOARD::BOARD() : used_cells(0), grid(9) {
+static constexpr array<uint8_t, 19683> build_terminal_table() {
+    const int lines[8][3] = {{0, 1, 2}, {3, 4, 5}, {6, 7, 8},  // rows
+                             {0, 3, 6}, {1, 4, 7}, {2, 5, 8},  // columns
+                             {0, 4, 8}, {2, 4, 6}};            // diagonals
+    array<uint8_t, 19683> table{};
+    for(int code = 0; code < 19683; code++) {
+        int cells[9] = {};
+        int empty = 0;
+        for(int i = 0, c = code; i < 9; i++, c /= 3) {
+            cells[i] = c % 3;
+            empty += cells[i] == 0;
+        }
+
+        int status = empty == 0 ? DRAWN : ONGOING;
+        for(int l = 7; l >= 0; l--) {
+            int first = cells[lines[l][0]];
+            if(first != 0 && first == cells[lines[l][1]] && first == cells[lines[l][2]])
+                status = first == 1 || status == X_WINS ? X_WINS : O_WINS;
+        }
+        table[code] = (uint8_t)(status | (empty << 4));
+    }
+    return table;
+}
+
+static constexpr array<uint8_t, 19683> TERMINAL_TABLE = build_terminal_table();
+
+/**
+ * @brief Constructs an empty board.
+ */
+template<int ROWS, int COLS, int K>
+BOARD_T<ROWS, COLS, K>::BOARD_T() : code(0), bits{0, 0}, used_cells(0), winner(EMPTY_CELL), win_cells(0), grid(CELLS) {
     reset_board();
 }
 
 /**
  * @brief Resets the board to its default settings
  */
-void BOARD::reset_board(void) {
+template<int ROWS, int COLS, int K>
+void BOARD_T<ROWS, COLS, K>::reset_board(void) {
     for (auto& symbol : grid)
         symbol = EMPTY_CELL;
+    code = 0;
+    bits[0] = bits[1] = 0;
     used_cells = 0;
+    winner = EMPTY_CELL;
+    win_cells = 0;
 }
 
 /**
  * @brief Checks if a move is valid.
  */
-bool BOARD::valid_move(short int x, short int y) {
+template<int ROWS, int COLS, int K>
+bool BOARD_T<ROWS, COLS, K>::valid_move(short int x, short int y) {
     // Move is out of bounds
-    if(x < 0 || x > 2 || y < 0 || y > 2)
+    if(x < 0 || x >= ROWS || y < 0 || y >= COLS)
         return false;
 
     // Cell is already used
-    if(grid[x*3 + y] != EMPTY_CELL)
+    if(grid[x*COLS + y] != EMPTY_CELL)
         return false;
 
     return true;
@@ -41,78 +94,218 @@ bool BOARD::valid_move(short int x, short int y) {
 /**
  * @brief Prints the current board state to the console.
  */
-void BOARD::draw_board(void) {
-    cout << "-------------" << endl;
-    for (int i = 0; i < 3; i++) {
+template<int ROWS, int COLS, int K>
+void BOARD_T<ROWS, COLS, K>::draw_board(void) {
+    string separator(COLS * 4 + 1, '-');
+    cout << separator << endl;
+    for (int i = 0; i < ROWS; i++) {
         cout << "| ";
-        for (int j = 0; j < 3; j++) {
-            cout << grid[i*3 + j] << " | ";
+        for (int j = 0; j < COLS; j++) {
+            cout << grid[i*COLS + j] << " | ";
         }
-        cout << endl << "-------------" << endl;
+        cout << endl << separator << endl;
     }
 }
 
 /**
  * @brief Checks if there are moves left on the board.
  */
-bool BOARD::isMoveLeft(void){
-    for(int i = 0; i<9; i++) 
-        if(grid[i] == EMPTY_CELL)
-            return true;
-    return false;
+template<int ROWS, int COLS, int K>
+bool BOARD_T<ROWS, COLS, K>::isMoveLeft(void) const{
+    if constexpr (CLASSIC)
+        return (TERMINAL_TABLE[code] >> 4) != 0;
+    else
+        return used_cells < CELLS;
 }
 
 /**
  * @brief Checks if the board is full (resulting in a draw).
  */
-bool BOARD::full(void) {
-    return used_cells == 9;
+template<int ROWS, int COLS, int K>
+bool BOARD_T<ROWS, COLS, K>::full(void) {
+    if constexpr (CLASSIC)
+        return (TERMINAL_TABLE[code] >> 4) == 0;
+    else
+        return used_cells == CELLS;
 }
 
 /**
  * @brief Places a player's symbol on the board.
  */
-bool BOARD::make_move(char player, short int x, short int y) {
+template<int ROWS, int COLS, int K>
+bool BOARD_T<ROWS, COLS, K>::make_move(char player, short int x, short int y) {
     if(!valid_move(x, y))
-        return false;      
-    
-    grid[x*3 + y] = player;
-    used_cells++;
+        return false;
+
+    do_move(player, x*COLS + y);
     return true;
 }
 
 /**
  * @brief Checks if the last move resulted in a win.
  */
-bool BOARD::check_win(short int x, short int y) {
-    char symbol = grid[x*3 +y];
+template<int ROWS, int COLS, int K>
+bool BOARD_T<ROWS, COLS, K>::check_win(short int x, short int y) {
+    char symbol = grid[x*COLS +y];
     if(symbol == EMPTY_CELL)
         return false;
+    return get_winner() == symbol;
+}
+
+/**
+ * @brief Gets the symbol at a specific cell.
+ */
+template<int ROWS, int COLS, int K>
+char BOARD_T<ROWS, COLS, K>::get_cell(short int x, short int y) const {
+    if (x < 0 || x >= ROWS || y < 0 || y >= COLS) {
+        return '?';
+    }
+    // Converts (x, y) to the linear vector index (x * COLS + y)
+    return grid[x * COLS + y];
+}
+
+/**
+ * @brief Places a player's symbol on the board without validating it.
+ * Keeps the board code and bitboards up to date, so the searches can walk the
+ * game tree on a single board instead of copying it for every child.
+ * @param player The player's symbol ('X' or 'O').
+ * @param index The linear index of an empty cell (x*COLS + y).
+ */
+template<int ROWS, int COLS, int K>
+void BOARD_T<ROWS, COLS, K>::do_move(char player, short int index) {
+    grid[index] = player;
+    code += POW3[index] * cell_digit(player);
+    used_cells++;
+    int side = player == 'O';
+    bits[side] |= 1ULL << index;
+    if constexpr (!CLASSIC) {
+        if(winner == EMPTY_CELL) {
+            for(auto mask : line_masks) {
+                if((mask >> index & 1) && (bits[side] & mask) == mask) {
+                    winner = player;
+                    win_cells = used_cells;
+                    break;
+                }
+            }
+        }
+    }
+}
 
-    // Horizontal win
-    if(grid[x*3] == symbol && grid[x*3 + 1] == symbol && grid[x*3 + 2] == symbol)
-        return true;
+/**
+ * @brief Takes back the last move made with do_move.
+ * @param index The linear index of the cell to empty.
+ */
+template<int ROWS, int COLS, int K>
+void BOARD_T<ROWS, COLS, K>::undo_move(short int index) {
+    if constexpr (!CLASSIC) {
+        if(winner != EMPTY_CELL && win_cells == used_cells) {
+            winner = EMPTY_CELL;
+            win_cells = 0;
+        }
+    }
+    bits[grid[index] == 'O'] &= ~(1ULL << index);
+    code -= POW3[index] * cell_digit(grid[index]);
+    grid[index] = EMPTY_CELL;
+    used_cells--;
+}
+
+/**
+ * @brief Gets the symbol of the player who completed a line.
+ * @return The winner's symbol, or EMPTY_CELL if nobody won yet.
+ */
+template<int ROWS, int COLS, int K>
+char BOARD_T<ROWS, COLS, K>::get_winner(void) const {
+    if constexpr (CLASSIC) {
+        int status = TERMINAL_TABLE[code] & 3;
+        return status == X_WINS ? 'X' : status == O_WINS ? 'O' : EMPTY_CELL;
+    }
+    else
+        return winner;
+}
+
+/**
+ * @brief Gets the terminal status of the board (ONGOING, X_WINS, O_WINS or DRAWN).
+ */
+template<int ROWS, int COLS, int K>
+int BOARD_T<ROWS, COLS, K>::get_status(void) const {
+    if constexpr (CLASSIC)
+        return TERMINAL_TABLE[code] & 3;
+    else {
+        if(winner != EMPTY_CELL)
+            return winner == 'X' ? X_WINS : O_WINS;
+        return used_cells == CELLS ? DRAWN : ONGOING;
+    }
+}
 
-    // Vertical win
-    if(grid[y] == symbol && grid[3 + y] == symbol && grid[6 + y] == symbol)
-        return true;
+/**
+ * @brief Gets the base-3 code of the board (exact up to 40 cells).
+ */
+template<int ROWS, int COLS, int K>
+uint64_t BOARD_T<ROWS, COLS, K>::get_code(void) const {
+    return code;
+}
 
-    // Diagonal win
-    if(grid[0] != EMPTY_CELL && grid[0] == grid[4] && grid[0] == grid[8])
-        return true;
-    if(grid[2] != EMPTY_CELL && grid[2] == grid[4] && grid[4] == grid[6])
-        return true;
+/**
+ * @brief Gets the bitboard of a player (0 = 'X', 1 = 'O').
+ */
+template<int ROWS, int COLS, int K>
+uint64_t BOARD_T<ROWS, COLS, K>::get_bits(int side) const {
+    return bits[side];
+}
 
-    return false;
+/**
+ * @brief Gets the number of symbols on the board.
+ */
+template<int ROWS, int COLS, int K>
+int BOARD_T<ROWS, COLS, K>::get_used_cells(void) const {
+    return used_cells;
 }
 
 /**
- * @brief Gets the symbol at a specific cell.
+ * @brief Finds an outcome that is already certain with the line-occupancy masks,
+ * before the board is full or a line is complete.
+ *
+ * A line is open for a player while the other player has no stone on it, and it can
+ * only be completed if the player has enough moves left to fill it. With no such line
+ * for either player the game is a dead draw. The player to move wins if an open line
+ * misses one stone; otherwise, if the opponent has open lines missing one stone on two
+ * different cells, only one of them can be blocked and the opponent wins.
+ * @param to_move the symbol of the player who moves next
+ * @return DRAWN, X_WINS or O_WINS when the outcome is certain, ONGOING otherwise
  */
-char BOARD::get_cell(short int x, short int y) const {
-    if (x < 0 || x > 2 || y < 0 || y > 2) {
-        return '?'; 
+template<int ROWS, int COLS, int K>
+int BOARD_T<ROWS, COLS, K>::classify(char to_move) const {
+    int status = get_status();
+    if(status != ONGOING)
+        return status;
+
+    int side = to_move == 'O';
+    uint64_t mover = bits[side], other = bits[!side];
+    int empty = CELLS - used_cells;
+    // The player to move plays the odd moves of the ones left
+    int mover_moves = (empty + 1) / 2, other_moves = empty / 2;
+
+    bool alive = false;
+    uint64_t other_threats = 0;
+    for(auto mask : line_masks) {
+        if((mask & other) == 0) {
+            int missing = K - __builtin_popcountll(mask & mover);
+            if(missing == 1)
+                return side ? O_WINS : X_WINS;
+            alive |= missing <= mover_moves;
+        }
+        if((mask & mover) == 0) {
+            int missing = K - __builtin_popcountll(mask & other);
+            if(missing == 1)
+                other_threats |= mask & ~other;
+            alive |= missing <= other_moves;
+        }
     }
-    // Converts (x, y) to the linear vector index (x * 3 + y)
-    return grid[x * 3 + y];
-}
\ No newline at end of file
+    if(__builtin_popcountll(other_threats) >= 2)
+        return side ? X_WINS : O_WINS;
+    return alive ? ONGOING : DRAWN;
+}
+
+template class BOARD_T<3, 3, 3>;
+template class BOARD_T<4, 4, 4>;
+template class BOARD_T<5, 5, 4>;
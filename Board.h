@@ -5,6 +5,8 @@
 #include <iostream>
 #include <map>
 #include <string>
+#include <array>
+#include <cstdint>
 
 using namespace std;
 
@@ -14,27 +16,104 @@ const char EMPTY_CELL = ' '; // Defines an empty cell for the game board
 #define LOSS -1
 #define DRAW 0
 
+// Terminal status of a position, returned by BOARD_T::get_status
+#define ONGOING 0
+#define X_WINS 1
+#define O_WINS 2
+#define DRAWN 3
+
+/**
+ * @brief Number of winning lines (rows, columns and both diagonal directions) of a ROWSxCOLS board with K in a row.
+ */
+constexpr int count_lines(int rows, int cols, int k) {
+    int lines = 0;
+    if(k <= cols) lines += rows * (cols - k + 1);
+    if(k <= rows) lines += cols * (rows - k + 1);
+    if(k <= rows && k <= cols) lines += 2 * (rows - k + 1) * (cols - k + 1);
+    return lines;
+}
+
+/**
+ * @brief Builds the bitmask of every winning line at compile time (bit x*COLS + y is cell (x, y)).
+ */
+template<int ROWS, int COLS, int K>
+constexpr array<uint64_t, count_lines(ROWS, COLS, K)> build_line_masks() {
+    array<uint64_t, count_lines(ROWS, COLS, K)> masks{};
+    int l = 0;
+    const int dirs[4][2] = {{0, 1}, {1, 0}, {1, 1}, {1, -1}};
+    for(auto& d : dirs)
+        for(int x = 0; x < ROWS; x++)
+            for(int y = 0; y < COLS; y++) {
+                int end_x = x + d[0] * (K - 1), end_y = y + d[1] * (K - 1);
+                if(end_x < 0 || end_x >= ROWS || end_y < 0 || end_y >= COLS)
+                    continue;
+                uint64_t mask = 0;
+                for(int i = 0; i < K; i++)
+                    mask |= 1ULL << ((x + d[0] * i) * COLS + (y + d[1] * i));
+                masks[l++] = mask;
+            }
+    return masks;
+}
+
 /**
- * @class BOARD
- * @brief Manages the 3x3 grid state for a Tic-Tac-Toe game.
+ * @class BOARD_T
+ * @brief Manages the ROWSxCOLS grid state for a game of K in a row.
+ *
+ * The classic 3x3 game is BOARD (BOARD_T<3, 3, 3>) and answers its terminal
+ * checks from a constexpr table indexed by the base-3 board code. Bigger
+ * boards find the winner with the line masks of the last move's cell.
  */
-class BOARD {
+template<int ROWS, int COLS, int K>
+class BOARD_T {
+    static_assert(ROWS * COLS <= 64, "The bitboards hold at most 64 cells");
+    static_assert(K <= ROWS || K <= COLS, "K does not fit in the board");
+public:
+    static constexpr int CELLS = ROWS * COLS;
+    static constexpr int LINES = count_lines(ROWS, COLS, K);
+    static constexpr bool CLASSIC = ROWS == 3 && COLS == 3 && K == 3;
+    static constexpr array<uint64_t, LINES> line_masks = build_line_masks<ROWS, COLS, K>();
+
 private:
+    uint64_t code;          // Base-3 code of the grid: ' ' = 0, 'X' = 1, 'O' = 2, cell 0 is the lowest digit
+    uint64_t bits[2];       // Cells taken by 'X' [0] and by 'O' [1]
     short int used_cells;
+    char winner;            // Symbol that completed a line, EMPTY_CELL if none (not used by the classic board)
+    short int win_cells;    // Value of used_cells when the line was completed
 public:
     vector<char> grid;
 
-    BOARD();
+    BOARD_T();
     void reset_board(void);
-    
+
     // Protótipos dos Métodos
     bool valid_move(short int x, short int y);
     void draw_board(void);
-    bool isMoveLeft(void);
+    bool isMoveLeft(void) const;
     bool full(void);
     bool make_move(char player, short int x, short int y);
     bool check_win(short int x, short int y);
     char get_cell(short int x, short int y) const;
+
+    // In-place search API: no validation, every do_move must be undone in reverse order
+    void do_move(char player, short int index);
+    void undo_move(short int index);
+    char get_winner(void) const;
+    int get_status(void) const;
+    uint64_t get_code(void) const;
+    uint64_t get_bits(int side) const;
+    int get_used_cells(void) const;
+
+    // Outcome that is already certain before the game ends (ONGOING if none)
+    int classify(char to_move) const;
 };
 
-#endif // BOARD_H
\ No newline at end of file
+// Instantiated in Board.cpp
+extern template class BOARD_T<3, 3, 3>;
+extern template class BOARD_T<4, 4, 4>;
+extern template class BOARD_T<5, 5, 4>;
+
+typedef BOARD_T<3, 3, 3> BOARD;
+typedef BOARD_T<4, 4, 4> BOARD_4x4;
+typedef BOARD_T<5, 5, 4> BOARD_5x5;
+
+#endif // BOARD_H
@@ -1,3 +1,6 @@
+#ifndef BOT_CPP
+#define BOT_CPP
+
 #include <iostream>
 #include <array>
 #include <stdlib.h>
@@ -9,145 +12,61 @@
 #include <random>
 #include <fstream>
 #include <sstream>
+#include <memory_resource>
+#include <cstdint>
+#include <cstring>
 #include "Board.h"
+#include "Symmetry.h"
+#include "Philox.cpp"
 using namespace std;
 
+// Bytes of each bot's per-game arena (its history of the current game lives here)
+#define BOT_GAME_ARENA 1024
+// First block of each bot's genome arena, the next blocks grow geometrically
+#define BOT_GENOME_BLOCK 4096
+
+/**
+ * @brief Header of the binary genome format, followed by 'states' entries of
+ * CELLS key chars and CELLS 64-bit scores each.
+ */
+struct GENOME_BINARY_HEADER {
+    char magic[8];
+    int32_t rows, cols, k, states;
+};
+
+/**
+ * @brief Orders board states whatever their allocator, so a map with states from an
+ * arena can be searched with a plain vector<char> (no key is built for a lookup).
+ */
+struct STATE_LESS {
+    typedef void is_transparent;
+
+    template<class A, class B>
+    bool operator()(const A& a, const B& b) const {
+        return lexicographical_compare(a.begin(), a.end(), b.begin(), b.end());
+    }
+};
 
+template<int ROWS, int COLS, int K>
+class BOT_T {
+    static_assert(ROWS == COLS, "The canonical states need a square board");
+    typedef BOARD_T<ROWS, COLS, K> BOARD;
+    typedef SYMMETRY_T<ROWS> SYMMETRY;
+    static constexpr int CELLS = ROWS * COLS;
 
-class BOT {
     private:
-    // 'last_game' stores the sequence of board states for this bot in the current game
-    vector<vector<char>> last_game;
+    // Per-game scratch: an inline buffer, so a game's history never reaches the heap
+    alignas(max_align_t) char game_buffer[BOT_GAME_ARENA];
+    pmr::monotonic_buffer_resource game_arena;
+    // Genome storage: map nodes and scores come from blocks freed together with the bot
+    pmr::monotonic_buffer_resource genome_arena;
+
+    // 'last_game' stores the sequence of board states for this bot in the current game (CELLS chars each)
+    pmr::vector<char> last_game;
     // 'moves' stores the {x, y} coordinates for each move in 'last_game'
-    vector<pair<short, short>> moves;
-
-    /**
-     * @brief Rotates the board 90 degrees clockwise
-     * @param raw_grid The original grid (before rotating)
-     * @return the new rotated board grid
-     */
-    vector<char> rotate_grid(const vector<char>& raw_grid) {
-        vector<char> new_grid(9);
-        for(int i =0; i<3; i++){
-            for(int j =0; j<3; j++){
-                new_grid[i * 3 + j] = raw_grid[(2-j) * 3 + i];
-            }
-        }
-        return new_grid;
-    }
-
-    /**
-     * @brief Flips a grid horizontaly
-     * @param raw_grid The original grid (before flipping)
-     * @return the new flipped grid
-     */
-    vector<char> flip_grid(const vector<char>& grid) {
-        vector<char> flipped = grid;
-        for(int r = 0; r < 3; ++r) {
-            // Swap col 0 and col 2
-            swap(flipped[r*3 + 0], flipped[r*3 + 2]);
-        }
-        return flipped;
-    }
-
-    /**
-     * @brief Rotates a move pair 90 degrees clockwise
-     * @param raw_grid The original move pair (before rotating)
-     * @return the new rotated move pair
-     */
-    pair<short, short> rotate_move(const pair<short, short>& raw_move) {
-        return {raw_move.second, 2 - raw_move.first};
-    }
-
-    /**
-     * @brief Flips a move horizontaly
-     * @param raw_grid The original move pair (before flipping)
-     * @return the new flipped move pair
-     */
-    pair<short, short> flip_move(const pair<short, short>& raw_move) {
-        return {raw_move.first, 2 - raw_move.second};
-    }
-
-    /**
-     * @brief Finds the "Canonical" (standard) form of the board.
-     * Checks all 4 rotations and horizontal symmetry and returns the one that is lexicographically smallest.
-     * This ensures 0º, 90º , 180º , 270º and symmetrical versions of the same board
-     * all map to the same entry in the genomes map.
-     * @param raw_grid the original grid
-     * @param raw_move pair<x, y> the original move leading to the grid
-     * @param rotation the number of 90º rotations to get the canon board
-     * @param flip if the canon board was flipped or not
-     * @return pair<Canonical Grid, pair<rotated movement>>
-     */
-    pair<vector<char>, pair<short, short>> get_canonical(
-        const vector<char>& raw_grid,
-        const pair<short, short>& raw_move, 
-        int *rotation,
-        bool *flip
-    ) {
-        vector<char> canon_grid = raw_grid;
-        vector<char> curr_grid = raw_grid;
-        pair<short, short> canon_move = raw_move;
-        pair<short, short> curr_move = raw_move;
-        if(rotation != NULL && flip != NULL)
-            *rotation = *flip = 0;
-        int f = 0, r = 0;
-
-        // Try symmetry
-        for(; f <= 1; f++) {
-            // Try all rotations
-            for(; r <= 3; r++) {
-                // Lexicographical comparison
-                if (curr_grid < canon_grid) {
-                    canon_grid = curr_grid;
-                    canon_move = curr_move; 
-                    if(rotation != NULL && flip != NULL) {
-                        *rotation = r;
-                        *flip = f; 
-                    }                    
-                }
-                curr_grid = rotate_grid(curr_grid);
-                curr_move = rotate_move(curr_move);
-            }
-            curr_grid = flip_grid(curr_grid);
-            curr_move = flip_move(curr_move);
-            r = 0;
-        }
-        
-        return {canon_grid, canon_move};
-    }
-
-    /**
-     * @brief Returns a canonical grid and move to it's raw input based on the number of
-     * rotations and wether it was flipped or not
-     * @param canon_grid the canon grid
-     * @param canon_move pair<x, y> the canon move leading to the grid
-     * @param rotation the number of 90º rotations to get the canon board
-     * @param flip if the canon board was flipped or not
-     * @return pair<Canonical Grid, pair<rotated movement>>
-     */
-    pair<vector<char>, pair<short, short>> unget_canonical(
-        const vector<char>& canon_grid, 
-        const pair<short, short>& canon_move, 
-        const int& rotation,
-        const bool& flip
-    ) {
-        vector<char> raw_grid = canon_grid;
-        pair<short, short> raw_move = canon_move;
-
-        int rotations = (4 - rotation) % 4;
-    
-        for(int r = 0; r < rotations; r++) {
-            raw_grid = rotate_grid(raw_grid);
-            raw_move = rotate_move(raw_move);
-        }
-        if(flip) {
-            raw_grid = flip_grid(raw_grid);
-            raw_move = flip_move(raw_move);
-        }
-
-        return {raw_grid, raw_move};
-    }
+    pmr::vector<pair<short, short>> moves;
+    // Reused buffer for one board of 'last_game'
+    vector<char> scratch;
 
     /***
      * @brief Returns if a move is valid given a canon state of the board
@@ -155,15 +74,15 @@ class BOT {
      * @param x row
      * @param y column
      */
-    bool canon_valid_move(vector<char> canon, short x, short y) {
+    bool canon_valid_move(const vector<char>& canon, short x, short y) {
         // Move is out of bounds
-        if(x < 0 || x > 2)
+        if(x < 0 || x >= ROWS)
             return false;
-        if(y < 0 || y > 2)
+        if(y < 0 || y >= COLS)
             return false;
 
         // Cell is already used
-        if(canon[x*3 + y] != EMPTY_CELL)
+        if(canon[x*COLS + y] != EMPTY_CELL)
             return false;
 
         return true;
@@ -176,46 +95,121 @@ class BOT {
      * @param flip if the genomes were flipped or not
      * @return Ther raw genomes.
      */
-    vector<long long> raw_genomes(const vector<long long>& canon_genomes, const int& rotation, const bool& flip) {
-        vector<long long> raw = canon_genomes;
-        // rotates
-        int rotations = (4 - rotation) % 4;
-        for(int i = 0; i < rotations; i++){
-            for(int j =0; j<3; j++){
-                raw[i * 3 + j] = raw[(2-j) * 3 + i];
-            }
-        }
-        // Flips
-        for(int r = 0; r < 3; ++r) {
-            // Swap col 0 and col 2
-            swap(raw[r*3 + 0], raw[r*3 + 2]);
-        }
+    vector<long long> raw_genomes(const pmr::vector<long long>& canon_genomes, const int& rotation, const bool& flip) {
+        vector<long long> raw(CELLS);
+        for(short i = 0; i < CELLS; i++)
+            raw[SYMMETRY::untransform_cell(i, rotation, flip)] = canon_genomes[i];
         return raw;
     }
 
     public:
-    // 'genomes' maps a board state to a vector of 9 scores (one for each cell of the board)
-    map<vector<char>, vector<long long>> genomes;
+    // A board state and its scores, both stored in the bot's genome arena
+    typedef pmr::vector<char> STATE;
+    typedef pmr::vector<long long> GENOME;
+    // 'genomes' maps a board state to a vector of CELLS scores (one for each cell of the board)
+    pmr::map<STATE, GENOME, STATE_LESS> genomes;
     // The bot's symbol on the board
     char symbol;
+    // Share of a state's total score added to the chosen move after each result
+    float win_reward, draw_reward, loss_reward;
+    // Random numbers of the move choice: the trainer seeks it to (generation, individual),
+    // each game and ply then has its own numbers
+    PHILOX rng;
+
+    BOT_T(char symbol = 'X')
+        : game_arena(game_buffer, sizeof(game_buffer)), genome_arena(BOT_GENOME_BLOCK),
+          last_game(&game_arena), moves(&game_arena), scratch(CELLS), genomes(&genome_arena),
+          symbol(symbol), win_reward(0.2), draw_reward(0.1), loss_reward(-0.05) {
+        // A bot makes at most (CELLS + 1) / 2 moves per game
+        last_game.reserve(CELLS * ((CELLS + 1) / 2));
+        moves.reserve((CELLS + 1) / 2);
+    }
 
-    BOT(char symbol = 'X') : symbol(symbol) {}
+    BOT_T(const BOT_T& other) : BOT_T(other.symbol) {
+        *this = other;
+    }
 
-    BOT& operator=(const BOT& other) {
+    /**
+     * @brief Copies another bot. The old genomes are released in bulk with their arena,
+     * and the copies are allocated from it again (the containers keep their own arenas).
+     */
+    BOT_T& operator=(const BOT_T& other) {
+        if(this == &other)
+            return *this;
         this->last_game = other.last_game;
         this->moves = other.moves;
+        this->genomes.clear();
+        this->genome_arena.release();
         this->genomes = other.genomes;
         this->symbol = other.symbol;
+        this->win_reward = other.win_reward;
+        this->draw_reward = other.draw_reward;
+        this->loss_reward = other.loss_reward;
+        this->rng = other.rng;
         return *this;
     }
 
+    /**
+     * @brief The scores of a board state, added empty if the state is new (what genomes[state]
+     * would do, for a state that is not in the arena).
+     */
+    GENOME& genome_of(const vector<char>& state) {
+        auto found = genomes.find(state);
+        if(found == genomes.end())
+            found = genomes.emplace(piecewise_construct, forward_as_tuple(state.begin(), state.end()), forward_as_tuple()).first;
+        return found->second;
+    }
+
+    /**
+     * @brief The reward of a result with the current settings.
+     * @param result WIN, LOSS or DRAW
+     */
+    float reward_of(const short& result) const {
+        if(result == WIN)
+            return win_reward;
+        if(result == LOSS)
+            return loss_reward;
+        return draw_reward; // Give a smaller reward for drawing to prefer it over losing
+    }
+
+    /**
+     * @brief Adds reward * (sum of the state's scores) to one move of a canonical state.
+     * A move that had a positive score keeps at least 1.
+     * @param canon_board the canonical board state
+     * @param move_index the move's cell on the canonical board
+     * @param reward the share of the state's total score to add
+     */
+    void reinforce(const vector<char>& canon_board, short move_index, float reward) {
+        // New state of the board
+        if(genomes.count(canon_board) == 0)
+            new_board_state(canon_board);
+        GENOME& genome = genome_of(canon_board);
+
+        // Unvalid move
+        if(genome[move_index] == 0)
+            return;
+
+        // Apply the reward/penalty
+        long long total = 0;
+        for(auto& g : genome)
+            total += g;
+
+        long long new_chromossome = genome[move_index] + total * reward;
+        if(genome[move_index] > 0 && new_chromossome <= 0)
+            genome[move_index] = 1;
+        else
+            genome[move_index] = new_chromossome;
+    }
+
     /**
      * @brief Clears the bot's history regarding the last game played.
-     * This function does not reset the bot's genomes.
+     * This function does not reset the bot's genomes. It is O(1): the history only
+     * holds chars and moves, in memory reserved once in the bot's game arena.
      */
     void clear_history(void) {
         last_game.clear();
         moves.clear();
+        rng.next_game();
     }
 
     /**
@@ -225,8 +219,8 @@ class BOT {
      * @param y the columm of the last move.
      */
     void register_move(const vector<char>& grid, const short& x, const short& y) {
-        auto canon = get_canonical(grid, {x, y}, NULL, NULL);
-        last_game.push_back(canon.first);
+        auto canon = SYMMETRY::get_canonical(grid, {x, y}, NULL, NULL);
+        last_game.insert(last_game.end(), canon.first.begin(), canon.first.end());
         moves.push_back(canon.second);
     }
 
@@ -236,16 +230,16 @@ class BOT {
      * @return The sum of all the new chromossomes' scores
      */
     int new_board_state(const vector<char>& canon_grid) {
-        vector<long long> new_genome(9, 0);
+        GENOME& new_genome = genome_of(canon_grid);
+        new_genome.assign(CELLS, 0);
         int sum = 0;
-        for(short x = 0; x < 3; x++) 
-            for(short y = 0; y < 3; y++) 
+        for(short x = 0; x < ROWS; x++) 
+            for(short y = 0; y < COLS; y++) 
                 if(canon_valid_move(canon_grid, x, y)) {
-                    new_genome[x*3 + y] = 100;
+                    new_genome[x*COLS + y] = 100;
                     sum += 100;
                 }
                     
-        genomes[canon_grid] = new_genome;
         return sum;
     }
 
@@ -256,45 +250,13 @@ class BOT {
      */
     void update_genomes(const short& result) {
         int counter = 0;
-        float reward = 0;
-
-        if(result == WIN) {
-            reward = 0.2;
-        } else if(result == LOSS) {
-            reward = -0.05;
-        } else if(result == DRAW) {
-            reward = 0.1; // Give a smaller reward for drawing to prefer it over losing
-        }
+        float reward = reward_of(result);
 
         // Apply reward to all moves made in the game
-        for(auto& board : last_game) {
-            auto canon = get_canonical(board, moves[counter], NULL, NULL);
-            vector<char>& canon_board = canon.first;
-            pair<short, short>& canon_move = canon.second;
-            short move_index = canon_move.first * 3 + canon_move.second;
-            
-            // New state of the board
-            if(genomes.count(canon_board) == 0)
-                new_board_state(canon_board);
-            
-            // Unvalid move
-            if(genomes[canon_board][move_index] == 0) {
-                counter++;
-                continue;
-            }
-            
-            // Apply the reward/penalty
-            long long total = 0;
-            for(auto& g : genomes[canon_board])
-                total += g;
-                
-            long long new_chromossome = genomes[canon_board][move_index] + total * reward;
-            if(genomes[canon_board][move_index] > 0 && new_chromossome <= 0)
-                genomes[canon_board][move_index] = 1;
-            else
-                genomes[canon_board][move_index] = new_chromossome;
-
-            counter++;
+        for(; counter < (int)moves.size(); counter++) {
+            scratch.assign(last_game.begin() + counter * CELLS, last_game.begin() + (counter + 1) * CELLS);
+            auto canon = SYMMETRY::get_canonical(scratch, moves[counter], NULL, NULL);
+            reinforce(canon.first, canon.second.first * COLS + canon.second.second, reward);
         }
     }
 
@@ -302,24 +264,21 @@ class BOT {
      * @brief Chooses the bot's next move and guarantees it's valid.
      * @param board the current game's board.
      */
-    pair<short, short> choose_move(BOARD board) {
-        // Stores the sum of the chromossomes's scores
-        int sum_of_scores = 0;
+    pair<short, short> choose_move(const BOARD& board) {
+        // Stores the sum of the chromossomes's scores (long long: the scores grow with every reward)
+        long long sum_of_scores = 0;
         int rotation;
         bool flip;
-        auto canon = get_canonical(board.grid, {0,0}, &rotation, &flip);
+        auto canon = SYMMETRY::get_canonical(board.grid, {0,0}, &rotation, &flip);
         auto& canon_board = canon.first;
 
         if(genomes.count(canon_board) == 0) { // Creates a new genome
             sum_of_scores = new_board_state(canon_board);
         }
-        else {
-            for(short x = 0; x < 3; ++x) {
-                for(short y = 0; y < 3; ++y) {
-                    sum_of_scores += genomes[canon_board][x*3 + y];
-                }
-            }
-        }
+        const GENOME& genome = genomes.find(canon_board)->second;
+        if(sum_of_scores == 0)
+            for(auto& g : genome)
+                sum_of_scores += g;
 
         if(sum_of_scores == 0){
             if(board.isMoveLeft()){
@@ -330,20 +289,22 @@ class BOT {
         }
 
         // Picks a valid move at random based on a "Roulette Wheel Selection"
-        int random_pick = rand() % sum_of_scores;
-        int current_sum = 0;
+        rng.set_ply(board.get_used_cells());
+        long long random_pick = rng.below(sum_of_scores);
+        long long current_sum = 0;
         int index = 0;
-        for(; index < 9; ++index) {
-            current_sum += genomes[canon_board][index];
+        for(; index < CELLS; ++index) {
+            current_sum += genome[index];
             if(random_pick < current_sum)
                 break;
         }
-        auto raw = unget_canonical(canon_board, {index / 3, index % 3}, rotation, flip);
+        // The raw board is the current one, only the move has to be un-rotated
+        short raw = SYMMETRY::untransform_cell(index, rotation, flip);
         // Registers move
-        last_game.push_back(raw.first);
-        moves.push_back(raw.second);
+        last_game.insert(last_game.end(), board.grid.begin(), board.grid.end());
+        moves.push_back({raw / COLS, raw % COLS});
 
-        return {raw.second.first, raw.second.second};
+        return {raw / COLS, raw % COLS};
     }
 
     /**
@@ -353,14 +314,14 @@ class BOT {
     void print_genome(const BOARD &board, const pair<short, short>& move) {
         int rotation;
         bool flip;
-        auto canon = get_canonical(board.grid, move, &rotation, &flip);
+        auto canon = SYMMETRY::get_canonical(board.grid, move, &rotation, &flip);
         if(genomes.count(canon.first) == 0){
             cout << "This board state has no records\n";
             return;
         }
 
         // Un-rotates the genomes
-        auto raw = raw_genomes(genomes[canon.first], rotation, flip);
+        auto raw = raw_genomes(genome_of(canon.first), rotation, flip);
         for(auto& genome : raw)
             cout << genome << " ";
         cout << endl;
@@ -380,11 +341,11 @@ class BOT {
 
         // Iterate through each map entry
         for (const auto& entry : genomes) {
-            const vector<char>& board_key = entry.first;
-            const vector<long long>& scores = entry.second;
+            const STATE& board_key = entry.first;
+            const GENOME& scores = entry.second;
 
-            // Write the board key (9 characters)
-            for (int i = 0; i < 9; ++i) {
+            // Write the board key (CELLS characters)
+            for (int i = 0; i < CELLS; ++i) {
                 // Use a placeholder for the empty cell to avoid file parsing issues
                file << (board_key[i] == EMPTY_CELL ? '_' : board_key[i]);
             }
@@ -392,7 +353,7 @@ class BOT {
             // Separator
             file << " :"; // Note the space
 
-            // Write the 9 scores
+            // Write the CELLS scores
             for (auto& score : scores) {
                 file << " " << score;
             }
@@ -417,6 +378,7 @@ class BOT {
         }
 
         genomes.clear(); // Clear existing genomes before loading
+        genome_arena.release();
         string line;
         int line_count = 0;
 
@@ -430,22 +392,22 @@ class BOT {
             // Read the key part and the separator
             ss >> key_str >> separator;
 
-            if (key_str.length() != 9 || separator != ":") {
+            if ((int)key_str.length() != CELLS || separator != ":") {
                 cerr << "Warning: Skipping malformed line " << line_count << ": " << line << endl;
                 continue;
             }
 
             // Convert the key string back to vector<char>
-            vector<char> board_key(9);
-            for (int i = 0; i < 9; ++i) {
+            vector<char> board_key(CELLS);
+            for (int i = 0; i < CELLS; ++i) {
                 // Convert placeholder back to empty cell
                 board_key[i] = (key_str[i] == '_' ? EMPTY_CELL : key_str[i]);
             }
 
-            // Read the 9 scores
-            vector<long long> scores(9);
+            // Read the CELLS scores
+            vector<long long> scores(CELLS);
             bool read_success = true;
-            for (int i = 0; i < 9; ++i) {
+            for (int i = 0; i < CELLS; ++i) {
                 if (!(ss >> scores[i])) {
                     read_success = false;
                     break;
@@ -458,10 +420,85 @@ class BOT {
             }
 
             // Add the entry to the genomes map
-            genomes[board_key] = scores;
+            genome_of(board_key).assign(scores.begin(), scores.end());
         }
 
         file.close();
         return true;
     }
-};
\ No newline at end of file
+
+    /**
+     * @brief Hash of the genomes (FNV-1a over every state and score): bots with the same
+     * genomes have the same fingerprint, so it tells whether a bot changed.
+     */
+    uint64_t fingerprint(void) const {
+        uint64_t hash = 14695981039346656037ULL;
+        for (const auto& [board_key, scores] : genomes) {
+            for (char c : board_key)
+                hash = (hash ^ (uint8_t)c) * 1099511628211ULL;
+            for (long long score : scores)
+                hash = (hash ^ (uint64_t)score) * 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    /**
+     * @brief Appends the genomes to a buffer in the binary format (GENOME_BINARY_HEADER).
+     * The buffer can be sent to another process and read back with read_binary().
+     */
+    void write_binary(vector<uint8_t>& out) const {
+        GENOME_BINARY_HEADER header = {{'T', 'T', 'T', 'G', 'E', 'N', 'O', '1'}, ROWS, COLS, K, (int32_t)genomes.size()};
+        size_t offset = out.size();
+        out.resize(offset + sizeof(header) + genomes.size() * CELLS * (1 + sizeof(int64_t)));
+        uint8_t* cursor = out.data() + offset;
+        memcpy(cursor, &header, sizeof(header));
+        cursor += sizeof(header);
+        for (const auto& [board_key, scores] : genomes) {
+            memcpy(cursor, board_key.data(), CELLS);
+            cursor += CELLS;
+            for (long long score : scores) {
+                int64_t value = score;
+                memcpy(cursor, &value, sizeof(value));
+                cursor += sizeof(value);
+            }
+        }
+    }
+
+    /**
+     * @brief Replaces the genomes with the ones of a buffer written by write_binary().
+     * @param size bytes available in the buffer
+     * @return the bytes read, 0 if the buffer is not a complete set of genomes of this board
+     */
+    size_t read_binary(const uint8_t* data, size_t size) {
+        GENOME_BINARY_HEADER header;
+        if (size < sizeof(header))
+            return 0;
+        memcpy(&header, data, sizeof(header));
+        size_t bytes = sizeof(header) + (size_t)header.states * CELLS * (1 + sizeof(int64_t));
+        if (memcmp(header.magic, "TTTGENO1", 8) != 0 || header.rows != ROWS || header.cols != COLS ||
+            header.k != K || header.states < 0 || size < bytes)
+            return 0;
+
+        genomes.clear();
+        genome_arena.release();
+        const uint8_t* cursor = data + sizeof(header);
+        vector<char> board_key(CELLS);
+        for (int s = 0; s < header.states; s++) {
+            memcpy(board_key.data(), cursor, CELLS);
+            cursor += CELLS;
+            GENOME& scores = genome_of(board_key);
+            scores.resize(CELLS);
+            for (int i = 0; i < CELLS; i++) {
+                int64_t value;
+                memcpy(&value, cursor, sizeof(value));
+                scores[i] = value;
+                cursor += sizeof(value);
+            }
+        }
+        return bytes;
+    }
+};
+
+typedef BOT_T<3, 3, 3> BOT;
+
+#endif // BOT_CPP
@@ -0,0 +1,255 @@
+#ifndef CANONICAL_BATCH_CPP
+#define CANONICAL_BATCH_CPP
+
+#include <vector>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include "Board.h"
+#include "Symmetry.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CANONICAL_SIMD 1
+#endif
+using namespace std;
+
+/**
+ * @brief A 3x3 grid packed in 16 bytes: the CELLS chars of BOARD::grid, then zeros.
+ */
+struct alignas(16) PACKED_BOARD {
+    char cells[16];
+};
+
+/**
+ * @brief Builds the shuffle of each transform at compile time: byte j of the image
+ * takes the cell shuffle[t][j] of the board (0x80 clears the padding bytes).
+ */
+constexpr array<array<uint8_t, 16>, 8> build_canonical_shuffles() {
+    array<array<uint8_t, 16>, 8> shuffles{};
+    auto map = build_cell_map<3>();
+    for(int t = 0; t < 8; t++) {
+        for(int j = 0; j < 16; j++)
+            shuffles[t][j] = 0x80;
+        for(int i = 0; i < 9; i++)
+            shuffles[t][map[t][i]] = (uint8_t)i;
+    }
+    return shuffles;
+}
+
+/**
+ * @class CANONICAL_BATCH
+ * @brief Canonical forms of many 3x3 boards at once.
+ *
+ * A key is the base-3 number of a grid read from cell 0 (the most significant digit)
+ * to cell 8, with ' ' = 0, 'O' = 1 and 'X' = 2, so comparing keys is the same as
+ * comparing grids the way SYMMETRY::get_canonical does. canonicalize() returns, for
+ * every board, the smallest key among its 8 images and the id (flip*4 + rotation) of
+ * the transform giving it, the first id on ties like get_canonical.
+ *
+ * The SIMD kernels turn the cells into digits with one byte shuffle, build the
+ * images with one byte shuffle per transform (two per instruction with AVX2), and
+ * get the keys with two multiply-add steps. The kernel is chosen at run time from
+ * the CPU, with a scalar loop as the fallback.
+ */
+class CANONICAL_BATCH {
+    static constexpr array<array<uint8_t, 16>, 8> shuffles = build_canonical_shuffles();
+
+    static int digit(char cell) {
+        return cell == 'X' ? 2 : cell == 'O' ? 1 : 0;
+    }
+
+    public:
+    static constexpr int KEYS = 19683;
+    enum KERNEL { AUTO, SCALAR, SSE4, AVX2 };
+
+    static PACKED_BOARD pack(const vector<char>& grid) {
+        PACKED_BOARD board;
+        memset(board.cells, 0, sizeof(board.cells));
+        memcpy(board.cells, grid.data(), 9);
+        return board;
+    }
+
+    static vector<char> unpack_key(uint16_t key) {
+        vector<char> grid(9);
+        for(int i = 8; i >= 0; i--, key /= 3)
+            grid[i] = key % 3 == 2 ? 'X' : key % 3 == 1 ? 'O' : EMPTY_CELL;
+        return grid;
+    }
+
+    static void canonicalize_scalar(const PACKED_BOARD boards[], size_t count, uint16_t keys[], uint8_t transforms[]) {
+        for(size_t b = 0; b < count; b++) {
+            int digits[9];
+            for(int i = 0; i < 9; i++)
+                digits[i] = digit(boards[b].cells[i]);
+            int best = KEYS * 8;
+            for(int t = 0; t < 8; t++) {
+                int key = 0;
+                for(int j = 0; j < 9; j++)
+                    key = key * 3 + digits[shuffles[t][j]];
+                best = min(best, key * 8 + t);
+            }
+            keys[b] = (uint16_t)(best >> 3);
+            transforms[b] = (uint8_t)(best & 7);
+        }
+    }
+
+#ifdef CANONICAL_SIMD
+    __attribute__((target("sse4.1")))
+    static void canonicalize_sse4(const PACKED_BOARD boards[], size_t count, uint16_t keys[], uint8_t transforms[]) {
+        // ' ' = 0x20, 'O' = 0x4F and 'X' = 0x58: the low nibble finds the digit
+        const __m128i digit_table = _mm_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 2, 0, 0, 0, 0, 0, 0, 1);
+        const __m128i low_nibble = _mm_set1_epi8(0x0F);
+        // Pairs of cells (3, 1), then pairs of pairs (3^7, 3^5), (3^3, 3^1), (1, 0)
+        const __m128i pair_weights = _mm_setr_epi8(3, 1, 3, 1, 3, 1, 3, 1, 1, 0, 0, 0, 0, 0, 0, 0);
+        const __m128i quad_weights = _mm_setr_epi16(2187, 243, 27, 3, 1, 0, 0, 0);
+        const __m128i ids_low = _mm_setr_epi32(0, 1, 2, 3), ids_high = _mm_setr_epi32(4, 5, 6, 7);
+        __m128i masks[8];
+        for(int t = 0; t < 8; t++)
+            masks[t] = _mm_loadu_si128((const __m128i*)shuffles[t].data());
+
+        for(size_t b = 0; b < count; b++) {
+            __m128i cells = _mm_load_si128((const __m128i*)boards[b].cells);
+            __m128i digits = _mm_shuffle_epi8(digit_table, _mm_and_si128(cells, low_nibble));
+            __m128i sums[8];
+            for(int t = 0; t < 8; t++) {
+                __m128i image = _mm_shuffle_epi8(digits, masks[t]);
+                sums[t] = _mm_madd_epi16(_mm_maddubs_epi16(image, pair_weights), quad_weights);
+            }
+            __m128i low = _mm_hadd_epi32(_mm_hadd_epi32(sums[0], sums[1]), _mm_hadd_epi32(sums[2], sums[3]));
+            __m128i high = _mm_hadd_epi32(_mm_hadd_epi32(sums[4], sums[5]), _mm_hadd_epi32(sums[6], sums[7]));
+            __m128i best = _mm_min_epi32(_mm_add_epi32(_mm_slli_epi32(low, 3), ids_low),
+                                         _mm_add_epi32(_mm_slli_epi32(high, 3), ids_high));
+            best = _mm_min_epi32(best, _mm_shuffle_epi32(best, _MM_SHUFFLE(1, 0, 3, 2)));
+            best = _mm_min_epi32(best, _mm_shuffle_epi32(best, _MM_SHUFFLE(2, 3, 0, 1)));
+            int packed = _mm_cvtsi128_si32(best);
+            keys[b] = (uint16_t)(packed >> 3);
+            transforms[b] = (uint8_t)(packed & 7);
+        }
+    }
+
+    __attribute__((target("avx2")))
+    static void canonicalize_avx2(const PACKED_BOARD boards[], size_t count, uint16_t keys[], uint8_t transforms[]) {
+        const __m256i digit_table = _mm256_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 2, 0, 0, 0, 0, 0, 0, 1,
+                                                     0, 0, 0, 0, 0, 0, 0, 0, 2, 0, 0, 0, 0, 0, 0, 1);
+        const __m256i low_nibble = _mm256_set1_epi8(0x0F);
+        const __m256i pair_weights = _mm256_setr_epi8(3, 1, 3, 1, 3, 1, 3, 1, 1, 0, 0, 0, 0, 0, 0, 0,
+                                                      3, 1, 3, 1, 3, 1, 3, 1, 1, 0, 0, 0, 0, 0, 0, 0);
+        const __m256i quad_weights = _mm256_setr_epi16(2187, 243, 27, 3, 1, 0, 0, 0, 2187, 243, 27, 3, 1, 0, 0, 0);
+        const __m256i ids = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        // Each register shuffles with transform t in its low half and t + 4 in its high half
+        __m256i masks[4];
+        for(int t = 0; t < 4; t++)
+            masks[t] = _mm256_setr_m128i(_mm_loadu_si128((const __m128i*)shuffles[t].data()),
+                                         _mm_loadu_si128((const __m128i*)shuffles[t + 4].data()));
+
+        for(size_t b = 0; b < count; b++) {
+            __m256i cells = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i*)boards[b].cells));
+            __m256i digits = _mm256_shuffle_epi8(digit_table, _mm256_and_si256(cells, low_nibble));
+            __m256i sums[4];
+            for(int t = 0; t < 4; t++) {
+                __m256i image = _mm256_shuffle_epi8(digits, masks[t]);
+                sums[t] = _mm256_madd_epi16(_mm256_maddubs_epi16(image, pair_weights), quad_weights);
+            }
+            // Keys 0-3 in the low half and 4-7 in the high half
+            __m256i all = _mm256_hadd_epi32(_mm256_hadd_epi32(sums[0], sums[1]), _mm256_hadd_epi32(sums[2], sums[3]));
+            all = _mm256_add_epi32(_mm256_slli_epi32(all, 3), ids);
+            __m128i best = _mm_min_epi32(_mm256_castsi256_si128(all), _mm256_extracti128_si256(all, 1));
+            best = _mm_min_epi32(best, _mm_shuffle_epi32(best, _MM_SHUFFLE(1, 0, 3, 2)));
+            best = _mm_min_epi32(best, _mm_shuffle_epi32(best, _MM_SHUFFLE(2, 3, 0, 1)));
+            int packed = _mm_cvtsi128_si32(best);
+            keys[b] = (uint16_t)(packed >> 3);
+            transforms[b] = (uint8_t)(packed & 7);
+        }
+    }
+#endif
+
+    /**
+     * @brief The fastest kernel this CPU runs.
+     */
+    static KERNEL best_kernel(void) {
+#ifdef CANONICAL_SIMD
+        if(__builtin_cpu_supports("avx2"))
+            return AVX2;
+        if(__builtin_cpu_supports("sse4.1"))
+            return SSE4;
+#endif
+        return SCALAR;
+    }
+
+    static const char* kernel_name(KERNEL kernel) {
+        const char* names[4] = {"auto", "scalar", "SSE4.1", "AVX2"};
+        return names[kernel];
+    }
+
+    /**
+     * @brief Finds the canonical key and transform of every board.
+     * @param boards the boards, packed by pack()
+     * @param count number of boards
+     * @param keys output with the smallest key of each board
+     * @param transforms output with the transform id that gives that key
+     * @param kernel the kernel to run, AUTO picks the fastest one available
+     */
+    static void canonicalize(const PACKED_BOARD boards[], size_t count, uint16_t keys[], uint8_t transforms[], KERNEL kernel = AUTO) {
+        if(kernel == AUTO)
+            kernel = best_kernel();
+#ifdef CANONICAL_SIMD
+        if(kernel == AVX2) {
+            canonicalize_avx2(boards, count, keys, transforms);
+            return;
+        }
+        if(kernel == SSE4) {
+            canonicalize_sse4(boards, count, keys, transforms);
+            return;
+        }
+#endif
+        canonicalize_scalar(boards, count, keys, transforms);
+    }
+};
+
+/**
+ * @brief Canonicalizes random boards with every kernel available and with
+ * SYMMETRY::get_canonical, checking that they agree and reporting boards/s.
+ */
+inline void benchmark_canonical(int count = 1 << 20) {
+    vector<PACKED_BOARD> boards(count);
+    vector<vector<char>> grids(count, vector<char>(9));
+    uint64_t state = 0x2545F4914F6CDD1DULL;
+    const char symbols[3] = {EMPTY_CELL, 'X', 'O'};
+    for(int b = 0; b < count; b++) {
+        for(int i = 0; i < 9; i++) {
+            state ^= state << 13; state ^= state >> 7; state ^= state << 17;
+            grids[b][i] = symbols[state % 3];
+        }
+        boards[b] = CANONICAL_BATCH::pack(grids[b]);
+    }
+
+    vector<uint16_t> expected(count), keys(count);
+    vector<uint8_t> transforms(count);
+    auto start = chrono::steady_clock::now();
+    for(int b = 0; b < count; b++) {
+        auto canon = SYMMETRY::get_canonical(grids[b], {0, 0}, NULL, NULL);
+        int key = 0;
+        for(char cell : canon.first)
+            key = key * 3 + (cell == 'X' ? 2 : cell == 'O' ? 1 : 0);
+        expected[b] = (uint16_t)key;
+    }
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    cout << "SYMMETRY::get_canonical: " << count / ms / 1000.0 << " million boards/s\n";
+
+    // A CPU with a kernel runs the ones before it too
+    CANONICAL_BATCH::KERNEL best = CANONICAL_BATCH::best_kernel();
+    for(int kernel = CANONICAL_BATCH::SCALAR; kernel <= best; kernel++) {
+        start = chrono::steady_clock::now();
+        CANONICAL_BATCH::canonicalize(boards.data(), count, keys.data(), transforms.data(), (CANONICAL_BATCH::KERNEL)kernel);
+        ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        int mismatches = 0;
+        for(int b = 0; b < count; b++)
+            mismatches += keys[b] != expected[b];
+        cout << CANONICAL_BATCH::kernel_name((CANONICAL_BATCH::KERNEL)kernel) << ": " << count / ms / 1000.0
+             << " million boards/s, " << mismatches << " mismatches\n";
+    }
+}
+
+#endif // CANONICAL_BATCH_CPP
@@ -0,0 +1,340 @@
+#ifndef ENDGAME_TABLE_CPP
+#define ENDGAME_TABLE_CPP
+
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cstdio>
+#include <cstdint>
+#include <chrono>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "Board.h"
+using namespace std;
+
+// Value of a position for the player to move, as stored in the table (2 bits each)
+#define EGTB_UNKNOWN 0 // Not covered by the table or unreachable
+#define EGTB_WIN 1
+#define EGTB_DRAW 2
+#define EGTB_LOSS 3
+
+/**
+ * @brief Binomial coefficients C(n, k) up to n = 64, used to rank the positions of a stone count.
+ */
+constexpr array<array<uint64_t, 65>, 65> build_binomials() {
+    array<array<uint64_t, 65>, 65> c{};
+    for(int n = 0; n <= 64; n++) {
+        c[n][0] = 1;
+        for(int k = 1; k <= n; k++)
+            c[n][k] = c[n-1][k-1] + (k < n ? c[n-1][k] : 0);
+    }
+    return c;
+}
+
+/**
+ * @class ENDGAME_TABLE_T
+ * @brief Retrograde endgame table of a ROWSxCOLS board with K in a row.
+ *
+ * generate() solves every position with at least 'min_stones' stones, from the full
+ * boards back to 'min_stones', and writes the win/draw/loss value of each one in
+ * 2 bits and its distance to the end of the game (plies with best play) in a byte.
+ * open() maps that file read-only, so every process training on the same variant
+ * shares one page-cached copy, and probe() and distance() answer a position in O(1).
+ *
+ * Positions are stored from the point of view of the player to move: 'mover' holds
+ * its cells and 'other' the cells of the player who just moved. Either symbol may
+ * start a game, so a position with n stones is legal when 'other' has (n + 1) / 2 of
+ * them. Inside the layer of n stones a position is ranked by its occupied cells and
+ * then by which of them belong to 'other' (colex order of both subsets).
+ * File layout: a HEADER, the values of the layers min_stones..CELLS (4 positions per
+ * byte), then the distances of the same positions (1 byte each).
+ */
+template<int ROWS, int COLS, int K>
+class ENDGAME_TABLE_T {
+    static constexpr int CELLS = ROWS * COLS;
+    static constexpr uint64_t ALL_CELLS = CELLS == 64 ? ~0ULL : (1ULL << CELLS) - 1;
+    static constexpr array<array<uint64_t, 65>, 65> binomial = build_binomials();
+    static constexpr auto line_masks = BOARD_T<ROWS, COLS, K>::line_masks;
+
+    private:
+    struct HEADER {
+        char magic[8];
+        int32_t rows, cols, k, min_stones;
+    };
+
+    void *mapping;
+    size_t mapping_size;
+    const uint8_t *data;
+    const uint8_t *distances;
+    int min_stones;
+    uint64_t layer_offset[CELLS + 2];
+
+    ENDGAME_TABLE_T(const ENDGAME_TABLE_T&) = delete;
+    ENDGAME_TABLE_T& operator=(const ENDGAME_TABLE_T&) = delete;
+
+    static int other_count(int stones) {
+        return (stones + 1) / 2;
+    }
+
+    static uint64_t layer_size(int stones) {
+        return binomial[CELLS][stones] * binomial[stones][other_count(stones)];
+    }
+
+    /**
+     * @brief Fills the first index of every layer from 'first' on (relative to the first covered layer).
+     */
+    static void build_offsets(int first, uint64_t offsets[CELLS + 2]) {
+        offsets[first] = 0;
+        for(int n = first; n <= CELLS; n++)
+            offsets[n + 1] = offsets[n] + layer_size(n);
+    }
+
+    /**
+     * @brief Colex rank of a set of cells among the sets of the same size.
+     */
+    static uint64_t subset_rank(uint64_t set) {
+        uint64_t rank = 0;
+        for(int j = 1; set; j++, set &= set - 1)
+            rank += binomial[__builtin_ctzll(set)][j];
+        return rank;
+    }
+
+    /**
+     * @brief Index of a legal position inside its layer.
+     */
+    static uint64_t position_rank(uint64_t mover, uint64_t other) {
+        uint64_t occupied = mover | other, packed = 0;
+        int n = 0;
+        for(uint64_t rest = occupied; rest; rest &= rest - 1, n++)
+            if(other >> __builtin_ctzll(rest) & 1)
+                packed |= 1ULL << n;
+        return subset_rank(occupied) * binomial[n][other_count(n)] + subset_rank(packed);
+    }
+
+    static bool has_line(uint64_t cells) {
+        for(auto mask : line_masks)
+            if((cells & mask) == mask)
+                return true;
+        return false;
+    }
+
+    /**
+     * @brief Next set of the same size in colex order (Gosper's hack).
+     */
+    static uint64_t next_subset(uint64_t set) {
+        if(set == 0)
+            return 0;
+        uint64_t lowest = set & -set, ripple = set + lowest;
+        return ripple | (((set ^ ripple) >> 2) / lowest);
+    }
+
+    static int read_value(const uint8_t *table, uint64_t index) {
+        return (table[index >> 2] >> ((index & 3) * 2)) & 3;
+    }
+
+    /**
+     * @brief Bytes of the values and of the distances of a table that starts at 'first' stones.
+     */
+    static void section_sizes(int first, uint64_t& values, uint64_t& distances) {
+        uint64_t offsets[CELLS + 2];
+        build_offsets(first, offsets);
+        values = (offsets[CELLS + 1] + 3) / 4;
+        distances = offsets[CELLS + 1];
+    }
+
+    public:
+    ENDGAME_TABLE_T() : mapping(NULL), mapping_size(0), data(NULL), distances(NULL), min_stones(CELLS + 1) {}
+
+    ~ENDGAME_TABLE_T() {
+        close();
+    }
+
+    /**
+     * @brief Solves every position with at least 'min_stones' stones and writes the table.
+     * Each layer is solved from the layer with one stone more: a win takes the fastest
+     * winning move and a loss the slowest losing one.
+     * @param filename the table file to write
+     * @param min_stones fewest stones of a covered position (0 solves the whole game)
+     * @param print reports every layer (positions, values and longest forced win)
+     * @return true if the table was written
+     */
+    static bool generate(const string& filename, int min_stones = 0, bool print = true) {
+        if(min_stones < 0 || min_stones > CELLS)
+            return false;
+        auto start = chrono::steady_clock::now();
+        uint64_t offsets[CELLS + 2];
+        build_offsets(min_stones, offsets);
+        vector<uint8_t> table((offsets[CELLS + 1] + 3) / 4, 0);
+        // Plies to the end of the game with best play, of every position
+        vector<uint8_t> distance(offsets[CELLS + 1], 0);
+
+        for(int n = CELLS; n >= min_stones; n--) {
+            int o = other_count(n);
+            uint64_t base = offsets[n], index = 0;
+            long long counts[4] = {0, 0, 0, 0};
+            int longest_win = 0;
+
+            uint64_t occupied = n == 0 ? 0 : (1ULL << n) - 1;
+            for(uint64_t m = 0; m < binomial[CELLS][n]; m++, occupied = next_subset(occupied)) {
+                uint64_t packed = o == 0 ? 0 : (1ULL << o) - 1;
+                for(uint64_t s = 0; s < binomial[n][o]; s++, packed = next_subset(packed), index++) {
+                    // Spreads the packed bits over the occupied cells
+                    uint64_t other = 0, rest = occupied;
+                    for(int b = 0; rest; b++, rest &= rest - 1)
+                        if(packed >> b & 1)
+                            other |= rest & -rest;
+                    uint64_t mover = occupied & ~other;
+
+                    int value, plies = 0;
+                    if(has_line(mover))
+                        value = EGTB_UNKNOWN; // The player to move cannot have a line already
+                    else if(has_line(other))
+                        value = EGTB_LOSS;
+                    else if(n == CELLS)
+                        value = EGTB_DRAW;
+                    else {
+                        // Backs up the children: the mover's stone is added and the sides swap
+                        bool win = false, draw = false;
+                        int fastest_win = 255, slowest_loss = 0;
+                        for(uint64_t empty = ALL_CELLS & ~occupied; empty; empty &= empty - 1) {
+                            uint64_t child_other = mover | (empty & -empty);
+                            uint64_t child = position_rank(other, child_other);
+                            int child_value = read_value(table.data(), offsets[n + 1] + child);
+                            int child_plies = distance[offsets[n + 1] + child];
+                            if(child_value == EGTB_LOSS) {
+                                win = true;
+                                fastest_win = min(fastest_win, child_plies + 1);
+                            }
+                            else if(child_value == EGTB_DRAW)
+                                draw = true;
+                            else
+                                slowest_loss = max(slowest_loss, child_plies + 1);
+                        }
+                        value = win ? EGTB_WIN : draw ? EGTB_DRAW : EGTB_LOSS;
+                        plies = win ? fastest_win : draw ? 0 : slowest_loss;
+                    }
+
+                    uint64_t i = base + index;
+                    table[i >> 2] |= (uint8_t)(value << ((i & 3) * 2));
+                    distance[i] = (uint8_t)plies;
+                    counts[value]++;
+                    if(value == EGTB_WIN)
+                        longest_win = max(longest_win, plies);
+                }
+            }
+            if(print)
+                cout << "Stones " << n << ": " << index << " positions, " << counts[EGTB_WIN] << " wins, "
+                     << counts[EGTB_DRAW] << " draws, " << counts[EGTB_LOSS] << " losses, longest forced win "
+                     << longest_win << " plies\n";
+        }
+
+        FILE *file = fopen(filename.c_str(), "wb");
+        if(file == NULL) {
+            cerr << "Error: Could not open file for writing: " << filename << endl;
+            return false;
+        }
+        HEADER header = {{'T', 'T', 'T', 'E', 'G', 'T', 'B', '2'}, ROWS, COLS, K, min_stones};
+        bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+                  fwrite(table.data(), 1, table.size(), file) == table.size() &&
+                  fwrite(distance.data(), 1, distance.size(), file) == distance.size();
+        fclose(file);
+        if(print)
+            cout << "Endgame table: " << table.size() + distance.size() << " bytes written to " << filename << " in "
+                 << chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() << " ms\n";
+        return ok;
+    }
+
+    /**
+     * @brief Maps a table written by generate() for this board.
+     * @return true if the file exists and matches the board
+     */
+    bool open(const string& filename) {
+        close();
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if(fd < 0) {
+            cout << "Info: Could not open file for reading: " << filename << ". Playing without the endgame table." << endl;
+            return false;
+        }
+        struct stat info;
+        void *map = MAP_FAILED;
+        if(fstat(fd, &info) == 0 && (size_t)info.st_size >= sizeof(HEADER))
+            map = mmap(NULL, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if(map == MAP_FAILED) {
+            cerr << "Error: Could not map the endgame table: " << filename << endl;
+            return false;
+        }
+
+        HEADER header;
+        memcpy(&header, map, sizeof(header));
+        uint64_t offsets[CELLS + 2];
+        uint64_t values_size = 0, distances_size = 0;
+        bool valid = memcmp(header.magic, "TTTEGTB2", 8) == 0 && header.rows == ROWS && header.cols == COLS &&
+                     header.k == K && header.min_stones >= 0 && header.min_stones <= CELLS;
+        if(valid) {
+            build_offsets(header.min_stones, offsets);
+            section_sizes(header.min_stones, values_size, distances_size);
+            valid = (size_t)info.st_size == sizeof(HEADER) + values_size + distances_size;
+        }
+        if(!valid) {
+            cerr << "Error: " << filename << " is not an endgame table of this board" << endl;
+            munmap(map, info.st_size);
+            return false;
+        }
+
+        mapping = map;
+        mapping_size = info.st_size;
+        data = (const uint8_t*)map + sizeof(HEADER);
+        distances = data + values_size;
+        min_stones = header.min_stones;
+        memcpy(layer_offset, offsets, sizeof(offsets));
+        return true;
+    }
+
+    /**
+     * @brief Unmaps the table, probe() answers EGTB_UNKNOWN afterwards.
+     */
+    void close(void) {
+        if(mapping != NULL)
+            munmap(mapping, mapping_size);
+        mapping = NULL;
+        data = distances = NULL;
+        min_stones = CELLS + 1;
+    }
+
+    /**
+     * @brief Checks if positions with this many stones are in the table.
+     */
+    bool covers(int stones) const {
+        return data != NULL && stones >= min_stones;
+    }
+
+    /**
+     * @brief Looks a position up.
+     * @param mover cells of the player to move
+     * @param other cells of the player who just moved
+     * @return EGTB_WIN, EGTB_DRAW or EGTB_LOSS for the player to move, EGTB_UNKNOWN if not covered
+     */
+    int probe(uint64_t mover, uint64_t other) const {
+        int n = __builtin_popcountll(mover | other);
+        if(!covers(n) || __builtin_popcountll(other) != other_count(n))
+            return EGTB_UNKNOWN;
+        return read_value(data, layer_offset[n] + position_rank(mover, other));
+    }
+
+    /**
+     * @brief Plies to the end of the game with best play (0 for a draw), for a covered
+     * position; probe() tells whether it is a win, a draw or a loss.
+     */
+    int distance(uint64_t mover, uint64_t other) const {
+        int n = __builtin_popcountll(mover | other);
+        if(!covers(n) || __builtin_popcountll(other) != other_count(n))
+            return 0;
+        return distances[layer_offset[n] + position_rank(mover, other)];
+    }
+};
+
+#endif // ENDGAME_TABLE_CPP
@@ -0,0 +1,337 @@
+#ifndef ENUMERATOR_CPP
+#define ENUMERATOR_CPP
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <iostream>
+#include <unordered_set>
+#include "Board.h"
+#include "Symmetry.h"
+using namespace std;
+
+// Depth at which the game tree is cut into tasks for the worker threads
+#define ENUM_SPLIT_DEPTH 3
+// Shards of the shared set of written positions (each with its own lock)
+#define ENUM_SHARDS 64
+// Records a worker keeps before writing them to the file
+#define ENUM_BUFFER_RECORDS 4096
+
+/**
+ * @class ENUMERATOR_T
+ * @brief Walks every legal game of a ROWSxROWS board with a parallel depth-first search
+ * and writes a labeled dataset: every position (up to symmetry) with its minimax value
+ * and its optimal moves.
+ *
+ * The tree is cut at ENUM_SPLIT_DEPTH plies into tasks, which are dealt to the workers
+ * round-robin; a worker that runs out of tasks steals from the others. Every node of
+ * the tree is visited, so the game count is exact (255,168 on 3x3) and the node rate
+ * measures the move generation and win checks. Positions are deduplicated by their
+ * canonical form (first in a per-worker set, then in a sharded shared set) and each
+ * one is written once. The nodes above the cut are solved after the workers finish,
+ * from the values of the tasks.
+ * The whole tree is only small enough for the 3x3 board.
+ *
+ * File layout: a HEADER followed by RECORDs, in the order the workers found them.
+ * A record holds the canonical position from the point of view of the player to move,
+ * the value for that player (1 win, 0 draw, -1 loss) and the cells of the optimal
+ * moves in the same orientation (0 for finished games).
+ */
+template<int ROWS, int COLS, int K>
+class ENUMERATOR_T {
+    static_assert(ROWS == COLS, "The symmetries need a square board");
+    static_assert(ROWS * COLS <= 32, "A record holds at most 32 cells");
+    typedef SYMMETRY_T<ROWS> SYMMETRY;
+    static constexpr int CELLS = ROWS * COLS;
+    static constexpr uint64_t ALL_CELLS = (1ULL << CELLS) - 1;
+    static constexpr auto line_masks = BOARD_T<ROWS, COLS, K>::line_masks;
+
+    public:
+    struct HEADER {
+        char magic[8];
+        int32_t rows, cols, k, record_size;
+    };
+
+#pragma pack(push, 1)
+    struct RECORD {
+        uint32_t mover;         // Cells of the player to move
+        uint32_t other;         // Cells of the player who just moved
+        uint32_t best_moves;    // Cells of the optimal moves
+        int8_t value;           // Value for the player to move
+    };
+#pragma pack(pop)
+
+    private:
+    struct TASK {
+        uint64_t mover, other;
+        bool lost;              // The player to move has already lost
+        int value;
+    };
+
+    struct WORKER {
+        deque<int> tasks;
+        mutex lock;
+        unordered_set<uint64_t> seen;
+        vector<RECORD> buffer;
+        long long nodes = 0, games = 0, first_wins = 0, second_wins = 0, steals = 0;
+    };
+
+    struct SHARD {
+        mutex lock;
+        unordered_set<uint64_t> seen;
+    };
+
+    vector<TASK> tasks;
+    vector<WORKER> workers;
+    SHARD shards[ENUM_SHARDS];
+    FILE *file;
+    mutex file_lock;
+    long long records;
+
+    static bool wins(uint64_t cells, int cell) {
+        for(auto mask : line_masks)
+            if(((mask >> cell) & 1) && (cells & mask) == mask)
+                return true;
+        return false;
+    }
+
+    /**
+     * @brief Finds the canonical key of a position and the transform that produces it.
+     */
+    static uint64_t canonical(uint64_t mover, uint64_t other, int *transform) {
+        uint64_t best = ~0ULL;
+        for(int t = 0; t < 8; t++) {
+            uint64_t key = SYMMETRY::transform_bits(mover, t) | SYMMETRY::transform_bits(other, t) << CELLS;
+            if(key < best) {
+                best = key;
+                *transform = t;
+            }
+        }
+        return best;
+    }
+
+    void flush(WORKER& w) {
+        if(w.buffer.empty())
+            return;
+        lock_guard<mutex> guard(file_lock);
+        if(file != NULL)
+            fwrite(w.buffer.data(), sizeof(RECORD), w.buffer.size(), file);
+        records += w.buffer.size();
+        w.buffer.clear();
+    }
+
+    /**
+     * @brief Writes the record of a position, unless some worker already wrote it.
+     */
+    void emit(WORKER& w, uint64_t mover, uint64_t other, int value, uint64_t best_moves) {
+        // Most positions repeat with the same orientation, so the raw position is checked first
+        if(!w.seen.insert(mover | other << CELLS | 1ULL << 63).second)
+            return;
+        int t = 0;
+        uint64_t key = canonical(mover, other, &t);
+        if(!w.seen.insert(key).second)
+            return;
+        SHARD& shard = shards[(key * 0x9E3779B97F4A7C15ULL) >> 58];
+        {
+            lock_guard<mutex> guard(shard.lock);
+            if(!shard.seen.insert(key).second)
+                return;
+        }
+        w.buffer.push_back({(uint32_t)(key & ALL_CELLS), (uint32_t)(key >> CELLS),
+                            (uint32_t)SYMMETRY::transform_bits(best_moves, t), (int8_t)value});
+        if(w.buffer.size() >= ENUM_BUFFER_RECORDS)
+            flush(w);
+    }
+
+    /**
+     * @brief Counts a finished game: the player who just moved won, or the board is full.
+     */
+    void finish(WORKER& w, uint64_t mover, uint64_t other, bool lost) {
+        w.games++;
+        if(lost) {
+            // The player who just moved started the game when it made an odd move
+            if(__builtin_popcountll(mover | other) % 2)
+                w.first_wins++;
+            else
+                w.second_wins++;
+        }
+        emit(w, mover, other, lost ? -1 : 0, 0);
+    }
+
+    /**
+     * @brief Visits the whole subtree of a position.
+     * @return the value for the player to move
+     */
+    int visit(WORKER& w, uint64_t mover, uint64_t other, bool lost) {
+        w.nodes++;
+        uint64_t empty = ALL_CELLS & ~(mover | other);
+        if(lost || empty == 0) {
+            finish(w, mover, other, lost);
+            return lost ? -1 : 0;
+        }
+
+        int best = -2;
+        uint64_t best_moves = 0;
+        for(uint64_t moves = empty; moves; moves &= moves - 1) {
+            int cell = __builtin_ctzll(moves);
+            uint64_t next = mover | 1ULL << cell;
+            int value = -visit(w, other, next, wins(next, cell));
+            if(value > best) {
+                best = value;
+                best_moves = 0;
+            }
+            if(value == best)
+                best_moves |= 1ULL << cell;
+        }
+        emit(w, mover, other, best, best_moves);
+        return best;
+    }
+
+    /**
+     * @brief Cuts the tree into tasks, in depth-first order.
+     */
+    void split(uint64_t mover, uint64_t other, bool lost, int depth) {
+        uint64_t empty = ALL_CELLS & ~(mover | other);
+        if(depth == ENUM_SPLIT_DEPTH || lost || empty == 0) {
+            tasks.push_back({mover, other, lost, 0});
+            return;
+        }
+        for(uint64_t moves = empty; moves; moves &= moves - 1) {
+            int cell = __builtin_ctzll(moves);
+            uint64_t next = mover | 1ULL << cell;
+            split(other, next, wins(next, cell), depth + 1);
+        }
+    }
+
+    /**
+     * @brief Solves the nodes above the cut, reading the tasks in the order split() made them.
+     */
+    int combine(WORKER& w, uint64_t mover, uint64_t other, bool lost, int depth, size_t& next_task) {
+        uint64_t empty = ALL_CELLS & ~(mover | other);
+        if(depth == ENUM_SPLIT_DEPTH || lost || empty == 0)
+            return tasks[next_task++].value;
+
+        w.nodes++;
+        int best = -2;
+        uint64_t best_moves = 0;
+        for(uint64_t moves = empty; moves; moves &= moves - 1) {
+            int cell = __builtin_ctzll(moves);
+            uint64_t next = mover | 1ULL << cell;
+            int value = -combine(w, other, next, wins(next, cell), depth + 1, next_task);
+            if(value > best) {
+                best = value;
+                best_moves = 0;
+            }
+            if(value == best)
+                best_moves |= 1ULL << cell;
+        }
+        emit(w, mover, other, best, best_moves);
+        return best;
+    }
+
+    bool next_task(int id, int *task) {
+        WORKER& own = workers[id];
+        {
+            lock_guard<mutex> guard(own.lock);
+            if(!own.tasks.empty()) {
+                *task = own.tasks.back();
+                own.tasks.pop_back();
+                return true;
+            }
+        }
+        for(size_t i = 1; i < workers.size(); i++) {
+            WORKER& victim = workers[(id + i) % workers.size()];
+            lock_guard<mutex> guard(victim.lock);
+            if(!victim.tasks.empty()) {
+                *task = victim.tasks.front();
+                victim.tasks.pop_front();
+                own.steals++;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void work(int id) {
+        int task;
+        while(next_task(id, &task))
+            tasks[task].value = visit(workers[id], tasks[task].mover, tasks[task].other, tasks[task].lost);
+        flush(workers[id]);
+    }
+
+    public:
+    // Totals of the last run()
+    long long nodes, games, first_wins, second_wins, steals;
+    double time_ms;
+
+    ENUMERATOR_T() : file(NULL), records(0), nodes(0), games(0), first_wins(0), second_wins(0), steals(0), time_ms(0) {}
+
+    long long get_records(void) const {
+        return records;
+    }
+
+    /**
+     * @brief Enumerates every game from the empty board and writes the dataset.
+     * @param filename the dataset file, or "" to only count
+     * @param threads worker threads (0 uses every core)
+     * @return the value of the empty board for the first player
+     */
+    int run(const string& filename, int threads = 0) {
+        auto start = chrono::steady_clock::now();
+        if(threads <= 0)
+            threads = max(1u, thread::hardware_concurrency());
+
+        file = NULL;
+        if(!filename.empty()) {
+            file = fopen(filename.c_str(), "wb");
+            if(file == NULL)
+                cerr << "Error: Could not open file for writing: " << filename << endl;
+            else {
+                HEADER header = {{'T', 'T', 'T', 'E', 'N', 'U', 'M', '1'}, ROWS, COLS, K, (int32_t)sizeof(RECORD)};
+                fwrite(&header, sizeof(header), 1, file);
+            }
+        }
+        records = 0;
+        for(auto& shard : shards)
+            shard.seen.clear();
+        tasks.clear();
+        split(0, 0, false, 0);
+
+        workers = vector<WORKER>(threads);
+        for(size_t i = 0; i < tasks.size(); i++)
+            workers[i % threads].tasks.push_back(i);
+        vector<thread> pool;
+        for(int i = 1; i < threads; i++)
+            pool.emplace_back(&ENUMERATOR_T::work, this, i);
+        work(0);
+        for(auto& t : pool)
+            t.join();
+
+        size_t next = 0;
+        int value = combine(workers[0], 0, 0, false, 0, next);
+        flush(workers[0]);
+        if(file != NULL)
+            fclose(file);
+        file = NULL;
+
+        nodes = games = first_wins = second_wins = steals = 0;
+        for(auto& w : workers) {
+            nodes += w.nodes;
+            games += w.games;
+            first_wins += w.first_wins;
+            second_wins += w.second_wins;
+            steals += w.steals;
+        }
+        time_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        return value;
+    }
+};
+
+typedef ENUMERATOR_T<3, 3, 3> ENUMERATOR;
+
+#endif // ENUMERATOR_CPP
@@ -0,0 +1,279 @@
+#ifndef GAME_LOG_CPP
+#define GAME_LOG_CPP
+
+#include <string>
+#include <cstring>
+#include <cstdio>
+#include <cstdint>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include "Board.h"
+using namespace std;
+
+// Bytes the writer keeps before appending them to the file
+#define GAME_LOG_BUFFER (1 << 16)
+
+// Result of a logged game
+#define LOG_DRAW 0
+#define LOG_FIRST_WINS 1
+#define LOG_SECOND_WINS 2
+
+/**
+ * @brief Header of a game log. A log holds games of one board only.
+ */
+struct GAME_LOG_HEADER {
+    char magic[8];
+    int32_t rows, cols, k;
+};
+
+/**
+ * @brief One game of a log. 'moves' points into the reader's mapping, nothing is copied.
+ */
+struct GAME_RECORD {
+    const uint8_t *moves;   // Cell index of every move, in order
+    int count;              // Number of moves
+    int result;             // LOG_DRAW, LOG_FIRST_WINS or LOG_SECOND_WINS
+    char first_symbol;      // Symbol of the player who moved first
+};
+
+/**
+ * @class GAME_LOG_WRITER_T
+ * @brief Appends finished games to a log file through a buffer.
+ *
+ * Each game takes 1 + moves bytes: a tag byte (number of moves in bits 0-4, result in
+ * bits 5-6, bit 7 set when 'O' moved first) followed by the cell index of each move.
+ * A 3x3 game takes at most 10 bytes. Appending to an existing log keeps its games.
+ *
+ * The buffer only ever holds whole games and a flush is one write() to a descriptor
+ * opened with O_APPEND, so several writers (threads or processes) can append to the
+ * same log: the kernel places each flush at the end of the file in one piece. A new
+ * log is created with its header already in it (linked from a temporary file), so two
+ * writers that open it at the same time never both write a header.
+ */
+template<int ROWS, int COLS, int K>
+class GAME_LOG_WRITER_T {
+    static constexpr int CELLS = ROWS * COLS;
+    static_assert(CELLS < 32, "The number of moves must fit in 5 bits");
+
+    private:
+    int fd;
+    uint8_t buffer[GAME_LOG_BUFFER];
+    size_t used;
+    long long games;
+
+    GAME_LOG_WRITER_T(const GAME_LOG_WRITER_T&) = delete;
+    GAME_LOG_WRITER_T& operator=(const GAME_LOG_WRITER_T&) = delete;
+
+    /**
+     * @brief Creates the log with its header if it does not exist yet.
+     * @return false if the file could not be created
+     */
+    bool create(const string& filename) const {
+        // Unique to this process and writer
+        string temporary = filename + ".tmp" + to_string(getpid()) + "_" + to_string((uintptr_t)this);
+        int tmp = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_EXCL, 0644);
+        if(tmp < 0)
+            return false;
+        GAME_LOG_HEADER header = {{'T', 'T', 'T', 'G', 'L', 'O', 'G', '1'}, ROWS, COLS, K};
+        bool written = ::write(tmp, &header, sizeof(header)) == sizeof(header);
+        ::close(tmp);
+        // link() fails if the log exists, so only one writer's header ever becomes the log
+        bool created = written && (link(temporary.c_str(), filename.c_str()) == 0 || errno == EEXIST);
+        unlink(temporary.c_str());
+        return created;
+    }
+
+    /**
+     * @brief Writes all of 'size' bytes, going on after a short write.
+     */
+    bool write_all(const uint8_t* data, size_t size) {
+        while(size > 0) {
+            ssize_t written = ::write(fd, data, size);
+            if(written < 0 && errno == EINTR)
+                continue;
+            if(written <= 0)
+                return false;
+            data += written;
+            size -= written;
+        }
+        return true;
+    }
+
+    public:
+    GAME_LOG_WRITER_T() : fd(-1), used(0), games(0) {}
+
+    ~GAME_LOG_WRITER_T() {
+        close();
+    }
+
+    /**
+     * @brief Opens a log for appending, writing the header if the file is new.
+     * @return true if the file is open and holds games of this board
+     */
+    bool open(const string& filename) {
+        close();
+        if(access(filename.c_str(), F_OK) != 0)
+            create(filename);
+        fd = ::open(filename.c_str(), O_RDWR | O_APPEND);
+        if(fd < 0) {
+            cerr << "Error: Could not open file for writing: " << filename << endl;
+            return false;
+        }
+
+        GAME_LOG_HEADER header;
+        bool valid = pread(fd, &header, sizeof(header), 0) == sizeof(header) && memcmp(header.magic, "TTTGLOG1", 8) == 0 &&
+                     header.rows == ROWS && header.cols == COLS && header.k == K;
+        if(!valid) {
+            cerr << "Error: " << filename << " is not a game log of this board" << endl;
+            ::close(fd);
+            fd = -1;
+        }
+        return valid;
+    }
+
+    bool is_open(void) const {
+        return fd >= 0;
+    }
+
+    long long get_games(void) const {
+        return games;
+    }
+
+    /**
+     * @brief Adds a finished game to the buffer.
+     * @param moves cell index of every move
+     * @param count number of moves
+     * @param result LOG_DRAW, LOG_FIRST_WINS or LOG_SECOND_WINS
+     * @param first_symbol symbol of the player who moved first
+     */
+    void write(const uint8_t moves[], int count, int result, char first_symbol) {
+        if(fd < 0)
+            return;
+        if(used + count + 1 > GAME_LOG_BUFFER)
+            flush();
+        buffer[used] = (uint8_t)(count | result << 5 | (first_symbol == 'O') << 7);
+        memcpy(buffer + used + 1, moves, count);
+        used += count + 1;
+        games++;
+    }
+
+    /**
+     * @brief Appends the buffered games in one write().
+     */
+    void flush(void) {
+        if(fd >= 0 && used > 0 && !write_all(buffer, used))
+            cerr << "Error: Could not append to the game log" << endl;
+        used = 0;
+    }
+
+    void close(void) {
+        flush();
+        if(fd >= 0)
+            ::close(fd);
+        fd = -1;
+    }
+};
+
+/**
+ * @class GAME_LOG_READER_T
+ * @brief Maps a log written by GAME_LOG_WRITER_T and walks its games in order.
+ * next() only moves a pointer through the mapping, so reading allocates nothing.
+ */
+template<int ROWS, int COLS, int K>
+class GAME_LOG_READER_T {
+    private:
+    void *mapping;
+    size_t mapping_size;
+    const uint8_t *cursor;
+    const uint8_t *end;
+
+    GAME_LOG_READER_T(const GAME_LOG_READER_T&) = delete;
+    GAME_LOG_READER_T& operator=(const GAME_LOG_READER_T&) = delete;
+
+    public:
+    GAME_LOG_READER_T() : mapping(NULL), mapping_size(0), cursor(NULL), end(NULL) {}
+
+    ~GAME_LOG_READER_T() {
+        close();
+    }
+
+    /**
+     * @brief Maps a log of this board.
+     * @return true if the file exists and matches the board
+     */
+    bool open(const string& filename) {
+        close();
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if(fd < 0) {
+            cout << "Info: Could not open file for reading: " << filename << endl;
+            return false;
+        }
+        struct stat info;
+        void *map = MAP_FAILED;
+        if(fstat(fd, &info) == 0 && (size_t)info.st_size >= sizeof(GAME_LOG_HEADER))
+            map = mmap(NULL, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if(map == MAP_FAILED) {
+            cerr << "Error: Could not map " << filename << endl;
+            return false;
+        }
+
+        GAME_LOG_HEADER header;
+        memcpy(&header, map, sizeof(header));
+        if(memcmp(header.magic, "TTTGLOG1", 8) != 0 || header.rows != ROWS || header.cols != COLS || header.k != K) {
+            cerr << "Error: " << filename << " is not a game log of this board" << endl;
+            munmap(map, info.st_size);
+            return false;
+        }
+        madvise(map, info.st_size, MADV_SEQUENTIAL);
+        mapping = map;
+        mapping_size = info.st_size;
+        rewind();
+        return true;
+    }
+
+    void close(void) {
+        if(mapping != NULL)
+            munmap(mapping, mapping_size);
+        mapping = NULL;
+        cursor = end = NULL;
+    }
+
+    /**
+     * @brief Goes back to the first game.
+     */
+    void rewind(void) {
+        if(mapping == NULL)
+            return;
+        cursor = (const uint8_t*)mapping + sizeof(GAME_LOG_HEADER);
+        end = (const uint8_t*)mapping + mapping_size;
+    }
+
+    /**
+     * @brief Reads the next game.
+     * @return false at the end of the log (or at a game cut short by a crash)
+     */
+    bool next(GAME_RECORD& game) {
+        if(cursor >= end)
+            return false;
+        uint8_t tag = *cursor;
+        int count = tag & 31;
+        if(cursor + 1 + count > end)
+            return false;
+        game.moves = cursor + 1;
+        game.count = count;
+        game.result = (tag >> 5) & 3;
+        game.first_symbol = tag >> 7 ? 'O' : 'X';
+        cursor += 1 + count;
+        return true;
+    }
+};
+
+typedef GAME_LOG_WRITER_T<3, 3, 3> GAME_LOG_WRITER;
+typedef GAME_LOG_READER_T<3, 3, 3> GAME_LOG_READER;
+
+#endif // GAME_LOG_CPP
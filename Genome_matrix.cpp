@@ -0,0 +1,176 @@
+#ifndef GENOME_MATRIX_CPP
+#define GENOME_MATRIX_CPP
+
+#include <vector>
+#include <map>
+#include <random>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include "Board.h"
+#include "Bot.cpp"
+#include "Philox.cpp"
+using namespace std;
+
+/**
+ * @class GENOME_MATRIX_T
+ * @brief The genomes of a whole population in one block of memory.
+ *
+ * Every canonical state seen by any individual gets one id in a registry shared by
+ * the population, and the scores live in one [individual][state][CELLS] array. The
+ * row of an individual holds 'capacity' states, so the memory is
+ * individuals * capacity * (CELLS * 8 + 1) bytes, and it only changes when the registry
+ * outgrows the capacity (which then doubles). A mask per row marks the states the
+ * individual knows: a child averages the states both parents know and copies the ones
+ * only one of them knows, and only its known states go back into a bot, so a bot's
+ * genomes never grow to the states of the whole population. Mutation draws how many
+ * scores to skip until the next mutated one instead of one random number per score.
+ */
+template<int ROWS, int COLS, int K>
+class GENOME_MATRIX_T {
+    typedef BOT_T<ROWS, COLS, K> BOT;
+    static constexpr int CELLS = ROWS * COLS;
+
+    private:
+    map<vector<char>, int, STATE_LESS> registry;
+    vector<vector<char>> states;
+    // Scores of every individual, row after row
+    vector<long long> scores;
+    // Buffer for the next generation, swapped with 'scores'
+    vector<long long> next;
+    // Whether each individual knows each state, row after row, and its next-generation buffer
+    vector<uint8_t> known, next_known;
+    int individuals;
+    int capacity;
+    PHILOX rng;
+
+    long long* row(vector<long long>& data, int individual) {
+        return data.data() + (size_t)individual * capacity * CELLS;
+    }
+
+    uint8_t* mask(vector<uint8_t>& data, int individual) {
+        return data.data() + (size_t)individual * capacity;
+    }
+
+    /**
+     * @brief Grows every row to hold 'states' states, keeping the scores.
+     */
+    void reserve(int wanted) {
+        if(wanted <= capacity)
+            return;
+        int new_capacity = max(wanted, capacity * 2);
+        vector<long long> grown((size_t)individuals * new_capacity * CELLS, 0);
+        vector<uint8_t> grown_known((size_t)individuals * new_capacity, 0);
+        for(int i = 0; i < individuals; i++) {
+            copy(row(scores, i), row(scores, i) + (size_t)states.size() * CELLS,
+                 grown.data() + (size_t)i * new_capacity * CELLS);
+            copy(mask(known, i), mask(known, i) + states.size(), grown_known.data() + (size_t)i * new_capacity);
+        }
+        scores.swap(grown);
+        known.swap(grown_known);
+        next.assign(scores.size(), 0);
+        next_known.assign(known.size(), 0);
+        capacity = new_capacity;
+    }
+
+    public:
+    GENOME_MATRIX_T(int individuals, uint64_t seed = 0, int capacity = 1024)
+        : individuals(individuals), capacity(capacity), rng(seed) {
+        scores.assign((size_t)individuals * capacity * CELLS, 0);
+        next.assign(scores.size(), 0);
+        known.assign((size_t)individuals * capacity, 0);
+        next_known.assign(known.size(), 0);
+    }
+
+    /**
+     * @brief Finds the id of a canonical state, registering it if it is new (no individual knows it yet).
+     */
+    int state_id(const typename BOT::STATE& state) {
+        auto found = registry.find(state);
+        if(found != registry.end())
+            return found->second;
+        int id = states.size();
+        reserve(id + 1);
+        registry.emplace(vector<char>(state.begin(), state.end()), id);
+        states.emplace_back(state.begin(), state.end());
+        return id;
+    }
+
+    /**
+     * @brief Replaces the row of an individual with a bot's genomes.
+     */
+    void load(int individual, const BOT& bot) {
+        fill(mask(known, individual), mask(known, individual) + capacity, 0);
+        for(auto& [state, genome] : bot.genomes) {
+            int id = state_id(state);
+            copy(genome.begin(), genome.end(), row(scores, individual) + (size_t)id * CELLS);
+            mask(known, individual)[id] = 1;
+        }
+    }
+
+    /**
+     * @brief Writes the states an individual knows into a bot's genomes.
+     */
+    void store(int individual, BOT& bot) {
+        const long long* scores_row = row(scores, individual);
+        const uint8_t* known_row = mask(known, individual);
+        for(size_t id = 0; id < states.size(); id++)
+            if(known_row[id])
+                bot.genome_of(states[id]).assign(scores_row + id * CELLS, scores_row + (id + 1) * CELLS);
+    }
+
+    /**
+     * @brief Builds the next generation as BOT crossover does: child c averages the states
+     * both its parents know, copies the states only one of them knows, and mutates the
+     * states its second parent knows; a child with the same parent twice is copied unchanged.
+     * @param parents the two parents of every individual of the next generation
+     * @param rate chance of mutating each valid move's score
+     * @param step standard deviation of the mutation noise
+     * @param generation generation of the children: child c mutates with the stream (generation, c)
+     */
+    void breed(const vector<pair<int, int>>& parents, double rate, double step, uint32_t generation = 0) {
+        size_t used = states.size() * CELLS;
+        normal_distribution<double> noise_dist(0.0, step);
+        geometric_distribution<long long> skip_dist(max(min(rate, 1.0), 1e-9));
+
+        for(int child = 0; child < (int)parents.size(); child++) {
+            long long* out = row(next, child);
+            uint8_t* out_known = mask(next_known, child);
+            const long long* a = row(scores, parents[child].first);
+            const long long* b = row(scores, parents[child].second);
+            const uint8_t* a_known = mask(known, parents[child].first);
+            const uint8_t* b_known = mask(known, parents[child].second);
+            if(parents[child].first == parents[child].second) {
+                copy(a, a + used, out);
+                copy(a_known, a_known + states.size(), out_known);
+                continue;
+            }
+            // Average of the states both parents know, copy of the states only one knows
+            for(size_t id = 0; id < states.size(); id++) {
+                const long long* from = a_known[id] ? a : b;
+                out_known[id] = a_known[id] | b_known[id];
+                for(size_t i = id * CELLS; i < (id + 1) * CELLS; i++)
+                    out[i] = a_known[id] && b_known[id] ? (a[i] + b[i]) / 2 : from[i];
+            }
+            // Mutation of the second parent's states: only the scores that are hit are visited
+            if(rate <= 0)
+                continue;
+            rng.seek(generation, child, PHILOX_MUTATION);
+            for(size_t i = skip_dist(rng); i < used; i += 1 + skip_dist(rng)) {
+                // Occupied cells stay at 0
+                if(!b_known[i / CELLS] || out[i] == 0)
+                    continue;
+                int noise = noise_dist(rng);
+                out[i] = max(1LL, out[i] + noise);
+            }
+        }
+        for(int i = parents.size(); i < individuals; i++) {
+            copy(row(scores, i), row(scores, i) + used, row(next, i));
+            copy(mask(known, i), mask(known, i) + states.size(), mask(next_known, i));
+        }
+        scores.swap(next);
+        known.swap(next_known);
+    }
+};
+
+#endif // GENOME_MATRIX_CPP
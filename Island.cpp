@@ -0,0 +1,266 @@
+#ifndef ISLAND_CPP
+#define ISLAND_CPP
+
+#include <vector>
+#include <array>
+#include <string>
+#include <cstring>
+#include <thread>
+#include <chrono>
+#include <cstdint>
+#include <cerrno>
+#include <iostream>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "Board.h"
+#include "Bot.cpp"
+#include "Game_log.cpp"
+#include "Steady_state.cpp"
+using namespace std;
+
+// Islands (worker processes) of a run
+#define ISLAND_COUNT 4
+// Games each island plays between two migrations
+#define ISLAND_INTERVAL 2000
+// Best individuals each island sends to the next one at every migration
+#define ISLAND_MIGRANTS 2
+
+/**
+ * @class ISLANDS_T
+ * @brief Splits the evolution into islands that run in separate processes on this machine.
+ *
+ * Every island is a forked process with its own STEADY_STATE_T population, so each one
+ * has its own heap and the memory of a run grows with the number of processes, not
+ * inside one of them. The islands form a ring of Unix-domain socket pairs: every
+ * ISLAND_INTERVAL games an island sends copies of its ISLAND_MIGRANTS best individuals
+ * to the next island, in the binary genome format, and its worst individuals are
+ * replaced by the ones that arrive from the previous island. A message is a 64-bit
+ * length followed by the genomes; the sending runs on its own thread while the island
+ * reads, so a large message cannot block the whole ring. At the end every island
+ * reports its best individual to the parent process over another socket pair.
+ */
+template<int ROWS, int COLS, int K, class TEACHER = Optimal_algorithm_T<ROWS, COLS, K>>
+class ISLANDS_T {
+    typedef BOT_T<ROWS, COLS, K> BOT;
+    typedef STEADY_STATE_T<ROWS, COLS, K, TEACHER> STEADY_STATE;
+
+    public:
+    struct REPORT {
+        int64_t games, replacements, migrants_in, states;
+        double time_ms, fitness;
+    };
+
+    private:
+    static bool write_all(int fd, const void* data, size_t size) {
+        const uint8_t* cursor = (const uint8_t*)data;
+        while(size > 0) {
+            // A closed neighbour makes the send fail instead of raising SIGPIPE
+            ssize_t written = send(fd, cursor, size, MSG_NOSIGNAL);
+            if(written < 0 && errno == EINTR)
+                continue;
+            if(written <= 0)
+                return false;
+            cursor += written;
+            size -= written;
+        }
+        return true;
+    }
+
+    static bool read_all(int fd, void* data, size_t size) {
+        uint8_t* cursor = (uint8_t*)data;
+        while(size > 0) {
+            ssize_t got = read(fd, cursor, size);
+            if(got < 0 && errno == EINTR)
+                continue;
+            if(got <= 0)
+                return false;
+            cursor += got;
+            size -= got;
+        }
+        return true;
+    }
+
+    static bool send_message(int fd, const vector<uint8_t>& message) {
+        uint64_t size = message.size();
+        return write_all(fd, &size, sizeof(size)) && write_all(fd, message.data(), message.size());
+    }
+
+    static bool receive_message(int fd, vector<uint8_t>& message) {
+        uint64_t size;
+        if(!read_all(fd, &size, sizeof(size)))
+            return false;
+        message.resize(size);
+        return read_all(fd, message.data(), size);
+    }
+
+    /**
+     * @brief Sends the best individuals to the next island and replaces the worst with the ones received.
+     * @return the individuals received
+     */
+    int migrate(STEADY_STATE& steady, int to_next, int from_previous) {
+        vector<int> order = steady.ranked();
+        int count = min(migrants, steady.size() / 2);
+        vector<uint8_t> out, in;
+        for(int m = 0; m < count; m++)
+            steady[order[m]].bot.write_binary(out);
+
+        bool sent = false;
+        thread sender([&] { sent = send_message(to_next, out); });
+        bool received = receive_message(from_previous, in);
+        sender.join();
+        if(!sent || !received)
+            return 0;
+
+        int arrived = 0;
+        size_t offset = 0;
+        for(int m = 0; m < count; m++) {
+            int target = order[order.size() - 1 - m];
+            size_t used = steady[target].bot.read_binary(in.data() + offset, in.size() - offset);
+            if(used == 0)
+                break;
+            offset += used;
+            steady.reset_scores(target);
+            arrived++;
+        }
+        return arrived;
+    }
+
+    /**
+     * @brief Body of an island process: evolves, migrates and reports its best individual.
+     */
+    void island(int id, long long games, const TEACHER& teacher, const string& game_log_file,
+                int to_next, int from_previous, int to_parent) {
+        // Each island is a different key of the same counter-based generator
+        STEADY_STATE steady(individuals, seed + id);
+        steady.threads = 1;
+        steady.mutation_rate = mutation_rate;
+        steady.mutation_step = mutation_step;
+        steady.early_end = early_end;
+        if(!seed_file.empty())
+            for(int i = 0; i < steady.size(); i++)
+                steady[i].bot.load_genomes(seed_file);
+
+        REPORT report = {0, 0, 0, 0, 0, 0};
+        auto start = chrono::steady_clock::now();
+        for(long long played = 0; played < games; played += interval) {
+            steady.run(min<long long>(interval, games - played), teacher, game_log_file);
+            if(played + interval < games && islands > 1)
+                report.migrants_in += migrate(steady, to_next, from_previous);
+        }
+        report.time_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+        int best = steady.best();
+        report.games = games;
+        report.replacements = steady.get_replacements();
+        report.states = steady[best].bot.genomes.size();
+        report.fitness = steady[best].fitness();
+
+        vector<uint8_t> message(sizeof(report));
+        memcpy(message.data(), &report, sizeof(report));
+        steady[best].bot.write_binary(message);
+        send_message(to_parent, message);
+    }
+
+    public:
+    // Islands, individuals per island and migrants per migration
+    int islands, individuals, migrants;
+    // Games each island plays between two migrations
+    long long interval;
+    // Seed of the islands (island i uses seed + i); with one thread per island a run is reproducible
+    uint64_t seed;
+    double mutation_rate, mutation_step;
+    // When the games end early (EARLY_OFF, EARLY_DRAWS or EARLY_FORCED)
+    int early_end;
+    // Genomes every individual starts from ("" starts empty)
+    string seed_file;
+    // Reports of the islands and wall time of the last run()
+    vector<REPORT> reports;
+    double time_ms;
+
+    ISLANDS_T(int islands = ISLAND_COUNT)
+        : islands(max(islands, 1)), individuals(STEADY_INDIVIDUALS), migrants(ISLAND_MIGRANTS), interval(ISLAND_INTERVAL),
+          seed(0), mutation_rate(0.05), mutation_step(0.5), early_end(EARLY_OFF), time_ms(0) {}
+
+    /**
+     * @brief Forks the islands, lets each one play 'games' games and collects the best individual.
+     * Must be called while the process has no other threads.
+     * @param best receives the individual with the highest fitness over every island
+     * @param game_log_file log appended by every island ("" logs nothing)
+     * @return false if an island could not be started or did not report
+     */
+    bool run(long long games, const TEACHER& teacher, BOT& best, const string& game_log_file = "") {
+        auto start = chrono::steady_clock::now();
+        // A log that cannot be opened or belongs to another board stops the run before any fork
+        if(!game_log_file.empty()) {
+            GAME_LOG_WRITER_T<ROWS, COLS, K> log;
+            if(!log.open(game_log_file))
+                return false;
+        }
+
+        // ring[i] carries the migrants of island i to island i + 1, parent[i] its report
+        vector<array<int, 2>> ring(islands), parent(islands);
+        for(int i = 0; i < islands; i++)
+            if(socketpair(AF_UNIX, SOCK_STREAM, 0, ring[i].data()) != 0 || socketpair(AF_UNIX, SOCK_STREAM, 0, parent[i].data()) != 0) {
+                cerr << "Error: Could not create the sockets of the islands" << endl;
+                return false;
+            }
+
+        cout.flush();
+        vector<pid_t> children;
+        for(int i = 0; i < islands; i++) {
+            pid_t pid = fork();
+            if(pid < 0) {
+                cerr << "Error: Could not start island " << i << endl;
+                break;
+            }
+            if(pid == 0) {
+                int previous = (i + islands - 1) % islands;
+                for(int j = 0; j < islands; j++) {
+                    if(j != i)
+                        close(ring[j][0]);
+                    if(j != previous)
+                        close(ring[j][1]);
+                    close(parent[j][0]);
+                    if(j != i)
+                        close(parent[j][1]);
+                }
+                island(i, games, teacher, game_log_file, ring[i][0], ring[previous][1], parent[i][1]);
+                _exit(0);
+            }
+            children.push_back(pid);
+        }
+        for(int i = 0; i < islands; i++) {
+            close(ring[i][0]);
+            close(ring[i][1]);
+            close(parent[i][1]);
+        }
+
+        reports.clear();
+        double best_fitness = 0;
+        bool complete = (int)children.size() == islands;
+        for(int i = 0; i < (int)children.size(); i++) {
+            vector<uint8_t> message;
+            REPORT report;
+            if(!receive_message(parent[i][0], message) || message.size() < sizeof(report)) {
+                cerr << "Error: Island " << i << " did not report" << endl;
+                complete = false;
+                continue;
+            }
+            memcpy(&report, message.data(), sizeof(report));
+            if(reports.empty() || report.fitness > best_fitness) {
+                best.read_binary(message.data() + sizeof(report), message.size() - sizeof(report));
+                best_fitness = report.fitness;
+            }
+            reports.push_back(report);
+        }
+        for(int i = 0; i < islands; i++)
+            close(parent[i][0]);
+        for(pid_t pid : children)
+            waitpid(pid, NULL, 0);
+        time_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        return complete;
+    }
+};
+
+#endif // ISLAND_CPP
@@ -0,0 +1,311 @@
+#ifndef MCTS_CPP
+#define MCTS_CPP
+
+#include <vector>
+#include <cmath>
+#include <chrono>
+#include <cstdint>
+#include "Board.h"
+using namespace std;
+
+// Exploration constant of the UCT formula
+#define UCT_C 1.41421356
+
+/**
+ * @brief Builds, for every cell, the mask of all cells sharing a winning line with it
+ * (the playouts only test the lines through the last move).
+ */
+template<int ROWS, int COLS, int K>
+constexpr array<array<uint64_t, 4 * K>, ROWS * COLS> build_cell_lines() {
+    array<array<uint64_t, 4 * K>, ROWS * COLS> lines{};
+    array<int, ROWS * COLS> count{};
+    for(auto mask : build_line_masks<ROWS, COLS, K>())
+        for(int i = 0; i < ROWS * COLS; i++)
+            if((mask >> i) & 1)
+                lines[i][count[i]++] = mask;
+    return lines;
+}
+
+/**
+ * @class MCTS_T
+ * @brief Monte Carlo Tree Search player (UCT) with a configurable playout or time budget.
+ *
+ * It has the same findBestMove interface as Optimal_algorithm_T, so it can be the
+ * teacher of a TicTacToeMiniMax_T game. Its strength (and cost) grows with the budget.
+ * The tree is kept between calls: when the new position is a child or grandchild of
+ * the last root, that subtree becomes the new root and its playouts are reused.
+ */
+template<int ROWS, int COLS, int K>
+class MCTS_T {
+    typedef BOARD_T<ROWS, COLS, K> BOARD;
+    static constexpr int CELLS = ROWS * COLS;
+    static constexpr uint64_t ALL_CELLS = CELLS == 64 ? ~0ULL : (1ULL << CELLS) - 1;
+    static constexpr array<array<uint64_t, 4 * K>, CELLS> cell_lines = build_cell_lines<ROWS, COLS, K>();
+
+    private:
+    struct NODE {
+        int parent;
+        int first_child;
+        int next_sibling;
+        short cell;             // Move leading to this node
+        short winner;           // 0 = ongoing, 1 = the player who moved here won, 2 = draw
+        uint64_t untried;       // Moves not expanded yet
+        double visits;
+        double score;           // Sum of results for the player who moved here (win 1, draw 0.5)
+    };
+    vector<NODE> tree;
+    int root;
+    uint64_t root_bits[2];      // Position of the root: cells of the side to move [0] and of the other side [1]
+    uint64_t rng_state;
+
+    /**
+     * @brief xorshift64* generator, one per player so no state is shared between threads.
+     */
+    uint64_t next_random(void) {
+        rng_state ^= rng_state >> 12;
+        rng_state ^= rng_state << 25;
+        rng_state ^= rng_state >> 27;
+        return rng_state * 0x2545F4914F6CDD1DULL;
+    }
+
+    /**
+     * @brief Checks if the cell just taken completed a line of 'side'.
+     */
+    static bool wins(uint64_t side, int cell) {
+        for(auto mask : cell_lines[cell]) {
+            if(mask == 0)
+                break;
+            if((side & mask) == mask)
+                return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Picks a random set bit of a non-empty mask.
+     */
+    int random_cell(uint64_t mask) {
+        int n = (int)(next_random() % __builtin_popcountll(mask));
+        while(n--)
+            mask &= mask - 1;
+        return __builtin_ctzll(mask);
+    }
+
+    int new_node(int parent, short cell, short winner, uint64_t untried) {
+        tree.push_back({parent, -1, -1, cell, winner, untried, 0, 0});
+        return (int)tree.size() - 1;
+    }
+
+    /**
+     * @brief Plays random moves until the game ends.
+     * @param to_move cells of the player to move
+     * @param other cells of the player who just moved
+     * @return 1 if the player who just moved wins, 0 if it loses and 0.5 for a draw
+     */
+    double playout(uint64_t to_move, uint64_t other) {
+        bool turn = false; // false while 'to_move' is moving
+        while(true) {
+            uint64_t empty = ALL_CELLS & ~(to_move | other);
+            if(empty == 0)
+                return 0.5;
+            int cell = random_cell(empty);
+            if(!turn) {
+                to_move |= 1ULL << cell;
+                if(wins(to_move, cell))
+                    return 0;
+            }
+            else {
+                other |= 1ULL << cell;
+                if(wins(other, cell))
+                    return 1;
+            }
+            turn = !turn;
+        }
+    }
+
+    /**
+     * @brief Runs one selection, expansion, simulation and backpropagation step.
+     */
+    void iterate(void) {
+        uint64_t me = root_bits[0], them = root_bits[1]; // 'me' is always the side to move at 'node'
+        int node = root;
+
+        // Selection: descends through fully expanded nodes by UCT
+        while(tree[node].winner == 0 && tree[node].untried == 0) {
+            double log_n = log(tree[node].visits);
+            int best = -1;
+            double best_value = -1;
+            for(int c = tree[node].first_child; c != -1; c = tree[c].next_sibling) {
+                double value = tree[c].score / tree[c].visits + UCT_C * sqrt(log_n / tree[c].visits);
+                if(value > best_value) {
+                    best_value = value;
+                    best = c;
+                }
+            }
+            me |= 1ULL << tree[best].cell;
+            swap(me, them);
+            node = best;
+        }
+
+        // Expansion: adds one random untried move
+        double result;
+        if(tree[node].winner == 0) {
+            int cell = random_cell(tree[node].untried);
+            tree[node].untried &= ~(1ULL << cell);
+            me |= 1ULL << cell;
+            short winner = wins(me, cell) ? 1 : (me | them) == ALL_CELLS ? 2 : 0;
+            uint64_t untried = winner ? 0 : ALL_CELLS & ~(me | them);
+            int child = new_node(node, (short)cell, winner, untried);
+            tree[child].next_sibling = tree[node].first_child;
+            tree[node].first_child = child;
+            node = child;
+            swap(me, them);
+
+            // Simulation
+            result = winner == 1 ? 1 : winner == 2 ? 0.5 : playout(me, them);
+        }
+        else
+            result = tree[node].winner == 1 ? 1 : 0.5;
+
+        // Backpropagation: the result flips for every level
+        while(node != -1) {
+            tree[node].visits += 1;
+            tree[node].score += result;
+            result = 1 - result;
+            node = tree[node].parent;
+        }
+    }
+
+    /**
+     * @brief Copies the subtree of 'node' into a new tree, as its root.
+     */
+    void reroot(int node) {
+        vector<NODE> kept;
+        kept.reserve(tree.size());
+        vector<pair<int, int>> stack = {{node, -1}}; // {old index, new parent}
+        while(!stack.empty()) {
+            auto [old, parent] = stack.back();
+            stack.pop_back();
+            NODE copy = tree[old];
+            copy.parent = parent;
+            copy.first_child = -1;
+            kept.push_back(copy);
+            int index = (int)kept.size() - 1;
+            if(parent != -1) {
+                kept[index].next_sibling = kept[parent].first_child;
+                kept[parent].first_child = index;
+            }
+            else
+                kept[index].next_sibling = -1;
+            for(int c = tree[old].first_child; c != -1; c = tree[c].next_sibling)
+                stack.push_back({c, index});
+        }
+        tree.swap(kept);
+        root = 0;
+    }
+
+    /**
+     * @brief Finds the node of the current position among the last root's children and grandchildren.
+     * @return the node, or -1 if the position is not in the tree
+     */
+    int find_position(uint64_t me, uint64_t them) {
+        if(root == -1)
+            return -1;
+        if(root_bits[0] == me && root_bits[1] == them)
+            return root;
+        for(int c = tree[root].first_child; c != -1; c = tree[c].next_sibling) {
+            uint64_t moved = root_bits[0] | 1ULL << tree[c].cell;
+            if(moved == them && root_bits[1] == me)
+                return c;
+            for(int g = tree[c].first_child; g != -1; g = tree[g].next_sibling)
+                if(moved == me && (root_bits[1] | 1ULL << tree[g].cell) == them)
+                    return g;
+        }
+        return -1;
+    }
+
+    public:
+    struct Move {
+        int row, col;
+    };
+
+    // Optional report of the work done by a findBestMove call
+    struct SearchStats {
+        long long playouts;         // Playouts run by this call
+        long long reused;           // Playouts already in the reused subtree
+        double time_ms;             // Wall time spent in the search, in milliseconds
+        double playouts_per_sec;
+    };
+
+    char symbol;
+    // Budgets per move, 0 means unlimited (at least one of them must be set)
+    long long playout_budget;
+    double time_budget_ms;
+    // Keeps the tree between moves
+    bool reuse_tree;
+    // Totals over every call, to report the average speed
+    long long total_playouts;
+    double total_time_ms;
+
+    MCTS_T(char symbol = 'O', long long playout_budget = 10000, uint64_t seed = 0x9E3779B97F4A7C15ULL)
+        : root(-1), root_bits{0, 0}, rng_state(seed ? seed : 1), symbol(symbol), playout_budget(playout_budget),
+          time_budget_ms(0), reuse_tree(true), total_playouts(0), total_time_ms(0) {}
+
+    /**
+     * @brief Returns the most visited move after spending the budget.
+     * @param board the current board
+     * @param algorithm the symbol of the player to move (this player)
+     * @param bot the opponent's symbol
+     * @param stats optional report of the search
+     */
+    Move findBestMove(BOARD &board, char algorithm, char bot, SearchStats *stats = NULL) {
+        auto start = chrono::steady_clock::now();
+        uint64_t me = board.get_bits(algorithm == 'O'), them = board.get_bits(bot == 'O');
+        if((me | them) == ALL_CELLS || board.get_winner() != EMPTY_CELL)
+            return {-1, -1};
+
+        int node = reuse_tree ? find_position(me, them) : -1;
+        if(node == -1) {
+            tree.clear();
+            root = new_node(-1, -1, 0, ALL_CELLS & ~(me | them));
+        }
+        else if(node != root)
+            reroot(node);
+        root_bits[0] = me;
+        root_bits[1] = them;
+        long long reused = (long long)tree[root].visits;
+
+        long long playouts = 0;
+        while(true) {
+            if(playout_budget > 0 && playouts >= playout_budget)
+                break;
+            if(time_budget_ms > 0 && (playouts & 63) == 0 &&
+                chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() >= time_budget_ms)
+                break;
+            if(playout_budget <= 0 && time_budget_ms <= 0 && playouts >= 10000)
+                break;
+            iterate();
+            playouts++;
+        }
+
+        int best = -1;
+        for(int c = tree[root].first_child; c != -1; c = tree[c].next_sibling)
+            if(best == -1 || tree[c].visits > tree[best].visits)
+                best = c;
+
+        double time_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        total_playouts += playouts;
+        total_time_ms += time_ms;
+        if(stats != NULL) {
+            stats->playouts = playouts;
+            stats->reused = reused;
+            stats->time_ms = time_ms;
+            stats->playouts_per_sec = time_ms > 0 ? playouts * 1000.0 / time_ms : 0;
+        }
+        return {tree[best].cell / COLS, tree[best].cell % COLS};
+    }
+};
+
+typedef MCTS_T<3, 3, 3> MCTS;
+
+#endif // MCTS_CPP
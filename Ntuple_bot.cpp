@@ -0,0 +1,283 @@
+#ifndef NTUPLE_BOT_CPP
+#define NTUPLE_BOT_CPP
+
+#include <iostream>
+#include <vector>
+#include <array>
+#include <string>
+#include <cmath>
+#include <fstream>
+#include <stdlib.h>
+#include "Board.h"
+#include "Philox.cpp"
+using namespace std;
+
+// Most cells in one tuple (the lines hold K cells, the windows 4)
+#define NTUPLE_MAX_CELLS 8
+
+/**
+ * @brief Number of tuples of a ROWSxCOLS board: every winning line and every 2x2 window.
+ */
+constexpr int count_tuples(int rows, int cols, int k) {
+    return count_lines(rows, cols, k) + (rows - 1) * (cols - 1);
+}
+
+/**
+ * @brief Builds the cells of every tuple at compile time ({size, cell 0, cell 1, ...}).
+ */
+template<int ROWS, int COLS, int K>
+constexpr array<array<short, NTUPLE_MAX_CELLS + 1>, count_tuples(ROWS, COLS, K)> build_tuples() {
+    static_assert(K <= NTUPLE_MAX_CELLS, "A line does not fit in a tuple");
+    array<array<short, NTUPLE_MAX_CELLS + 1>, count_tuples(ROWS, COLS, K)> tuples{};
+    int t = 0;
+    for(auto mask : build_line_masks<ROWS, COLS, K>()) {
+        for(short i = 0; i < ROWS * COLS; i++)
+            if(mask >> i & 1)
+                tuples[t][++tuples[t][0]] = i;
+        t++;
+    }
+    for(int x = 0; x + 1 < ROWS; x++)
+        for(int y = 0; y + 1 < COLS; y++) {
+            tuples[t] = {4, (short)(x*COLS + y), (short)(x*COLS + y + 1), (short)((x+1)*COLS + y), (short)((x+1)*COLS + y + 1)};
+            t++;
+        }
+    return tuples;
+}
+
+/**
+ * @brief Total number of weights of the network: 3^size for every tuple.
+ */
+template<int ROWS, int COLS, int K>
+constexpr int count_weights() {
+    int total = 0;
+    for(auto& tuple : build_tuples<ROWS, COLS, K>()) {
+        int entries = 1;
+        for(int i = 0; i < tuple[0]; i++)
+            entries *= 3;
+        total += entries;
+    }
+    return total;
+}
+
+/**
+ * @class NTUPLE_BOT_T
+ * @brief Bot that scores moves with an n-tuple network instead of one genome per board state.
+ *
+ * Each tuple is a fixed set of cells (a winning line or a 2x2 window) with a table of
+ * 3^size weights, one per way of filling those cells with empty, own and opponent's
+ * symbols. A move is worth the sum of the tables read on the board after the move, so
+ * it costs one lookup per tuple, and the network has the same size however many
+ * positions it has seen (WEIGHTS floats). The moves are picked by a roulette wheel
+ * over exp(value / temperature), and update_genomes moves the value of every board the
+ * bot created in the last game towards the game's result.
+ * It has the interface of BOT_T, so the game runners can use either of them.
+ */
+template<int ROWS, int COLS, int K>
+class NTUPLE_BOT_T {
+    typedef BOARD_T<ROWS, COLS, K> BOARD;
+    static constexpr int CELLS = ROWS * COLS;
+
+    public:
+    static constexpr int TUPLES = count_tuples(ROWS, COLS, K);
+    static constexpr int WEIGHTS = count_weights<ROWS, COLS, K>();
+    static constexpr size_t MEMORY_BYTES = WEIGHTS * sizeof(float);
+
+    private:
+    static constexpr array<array<short, NTUPLE_MAX_CELLS + 1>, TUPLES> tuples = build_tuples<ROWS, COLS, K>();
+
+    // Weights of every tuple, one table after the other
+    vector<float> weights;
+    // First weight of each tuple's table
+    array<int, TUPLES> offsets;
+    // Weight indices read for each board the bot created in the current game
+    vector<array<int, TUPLES>> last_game;
+
+    /**
+     * @brief Finds the weight of every tuple on a grid, from the point of view of 'symbol'.
+     * @param played cell read as holding 'symbol' (the move being scored), so the board isn't copied
+     */
+    void read_tuples(const vector<char>& grid, short played, array<int, TUPLES>& indices) const {
+        for(int t = 0; t < TUPLES; t++) {
+            int index = 0;
+            for(int i = tuples[t][0]; i >= 1; i--) {
+                char cell = tuples[t][i] == played ? symbol : grid[tuples[t][i]];
+                index = index * 3 + (cell == EMPTY_CELL ? 0 : cell == symbol ? 1 : 2);
+            }
+            indices[t] = offsets[t] + index;
+        }
+    }
+
+    float value(const array<int, TUPLES>& indices) const {
+        float sum = 0;
+        for(int index : indices)
+            sum += weights[index];
+        return sum;
+    }
+
+    public:
+    // The bot's symbol on the board
+    char symbol;
+    // Step of the weight updates and randomness of the move choice
+    float learning_rate;
+    float temperature;
+    // Random numbers of the move choice, one stream per game and ply
+    PHILOX rng;
+
+    NTUPLE_BOT_T(char symbol = 'X') : weights(WEIGHTS, 0.0f), symbol(symbol), learning_rate(0.1f), temperature(0.1f) {
+        int offset = 0;
+        for(int t = 0; t < TUPLES; t++) {
+            offsets[t] = offset;
+            int entries = 1;
+            for(int i = 0; i < tuples[t][0]; i++)
+                entries *= 3;
+            offset += entries;
+        }
+    }
+
+    /**
+     * @brief Clears the bot's history regarding the last game played.
+     */
+    void clear_history(void) {
+        last_game.clear();
+        rng.next_game();
+    }
+
+    /**
+     * @brief Scores every empty cell: the value of the board after playing it.
+     * @param scores output with one score per cell (-INFINITY for taken cells)
+     */
+    void score_moves(const BOARD& board, array<float, CELLS>& scores) const {
+        array<int, TUPLES> indices;
+        for(short i = 0; i < CELLS; i++) {
+            scores[i] = -INFINITY;
+            if(board.grid[i] != EMPTY_CELL)
+                continue;
+            read_tuples(board.grid, i, indices);
+            scores[i] = value(indices);
+        }
+    }
+
+    /**
+     * @brief Chooses the bot's next move and guarantees it's valid.
+     * @param board the current game's board.
+     */
+    pair<short, short> choose_move(const BOARD& board) {
+        array<float, CELLS> scores;
+        score_moves(board, scores);
+
+        float best = -INFINITY;
+        for(float s : scores)
+            best = max(best, s);
+        if(best == -INFINITY)
+            return {-1, -1};
+
+        // Roulette wheel over exp(score / temperature), shifted by the best score to stay finite
+        array<double, CELLS> chances;
+        double sum = 0;
+        for(int i = 0; i < CELLS; i++) {
+            chances[i] = scores[i] == -INFINITY ? 0 : exp((scores[i] - best) / max(temperature, 1e-6f));
+            sum += chances[i];
+        }
+        rng.set_ply(board.get_used_cells());
+        double pick = (double)(rng.next64() >> 11) / (1ULL << 53) * sum;
+        int index = 0;
+        for(; index < CELLS - 1; index++) {
+            if(chances[index] > 0 && pick < chances[index])
+                break;
+            pick -= chances[index];
+        }
+        while(scores[index] == -INFINITY)
+            index--;
+
+        // Registers the board created by the move
+        last_game.emplace_back();
+        read_tuples(board.grid, index, last_game.back());
+        return {index / COLS, index % COLS};
+    }
+
+    /**
+     * @brief Moves the value of the boards of the last game towards its result.
+     * @param result 1 if the bot won, -1 if it lost and 0 if it's a draw.
+     */
+    void update_genomes(const short& result) {
+        float target = result == WIN ? 1.0f : result == DRAW ? 0.5f : -1.0f;
+        for(auto& indices : last_game) {
+            float step = learning_rate * (target - value(indices)) / TUPLES;
+            for(int index : indices)
+                weights[index] += step;
+        }
+    }
+
+    /**
+     * @brief Prints the score of every cell for the current board, like BOT_T::print_genome.
+     */
+    void print_genome(const BOARD &board, const pair<short, short>& move) {
+        array<float, CELLS> scores;
+        score_moves(board, scores);
+        for(float s : scores) {
+            if(s == -INFINITY)
+                cout << "- ";
+            else
+                cout << s << " ";
+        }
+        cout << "(move " << move.first << ", " << move.second << ")" << endl;
+    }
+
+    /**
+     * @brief Saves the network to a text file: a header line with ROWS, COLS, K and
+     * WEIGHTS, then one line with the weights of each tuple.
+     * @param filename The name of the file to save to.
+     * @return true if saving was successful, false otherwise.
+     */
+    bool save_genomes(const string& filename) {
+        ofstream file(filename);
+        if(!file.is_open()) {
+            cerr << "Error: Could not open file for writing: " << filename << endl;
+            return false;
+        }
+
+        file << "NTUPLE " << ROWS << " " << COLS << " " << K << " " << WEIGHTS << "\n";
+        for(int t = 0; t < TUPLES; t++) {
+            int end = t + 1 < TUPLES ? offsets[t + 1] : WEIGHTS;
+            for(int i = offsets[t]; i < end; i++)
+                file << weights[i] << (i + 1 < end ? " " : "\n");
+        }
+
+        file.close();
+        return true;
+    }
+
+    /**
+     * @brief Loads a network saved by save_genomes for the same board.
+     * @param filename The name of the file to load from.
+     * @return true if loading was successful, false otherwise.
+     */
+    bool load_genomes(const string& filename) {
+        ifstream file(filename);
+        if(!file.is_open()) {
+            cout << "Info: Could not open file for reading: " << filename << ". Starting with an empty network." << endl;
+            return false;
+        }
+
+        string tag;
+        int rows, cols, k, count;
+        if(!(file >> tag >> rows >> cols >> k >> count) || tag != "NTUPLE" || rows != ROWS || cols != COLS || k != K || count != WEIGHTS) {
+            cerr << "Error: " << filename << " is not a network of this board" << endl;
+            return false;
+        }
+        vector<float> loaded(WEIGHTS);
+        for(auto& w : loaded)
+            if(!(file >> w)) {
+                cerr << "Error: " << filename << " has fewer than " << WEIGHTS << " weights" << endl;
+                return false;
+            }
+        weights.swap(loaded);
+
+        file.close();
+        return true;
+    }
+};
+
+typedef NTUPLE_BOT_T<3, 3, 3> NTUPLE_BOT;
+
+#endif // NTUPLE_BOT_CPP
@@ -1,93 +1,124 @@
 #include "Board.h"
+#include "Symmetry.h"
+#include <chrono>
+#include <atomic>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <algorithm>
+#include "Transposition_table.cpp"
+#include "Endgame_table.cpp"
+
+// Size of the transposition table of the parallel search (2^TT_SIZE_LOG2 slots of 16 bytes)
+#define TT_SIZE_LOG2 20
+
+/**
+ * @brief Static move-ordering priority of each cell: the number of winning lines through it
+ * (on 3x3: center, then corners, then edges).
+ */
+template<int ROWS, int COLS, int K>
+constexpr array<int, ROWS * COLS> build_cell_priority() {
+    array<int, ROWS * COLS> priority{};
+    for(auto mask : build_line_masks<ROWS, COLS, K>())
+        for(int i = 0; i < ROWS * COLS; i++)
+            priority[i] += (mask >> i) & 1;
+    return priority;
+}
+
+template<int ROWS, int COLS, int K>
+class Optimal_algorithm_T{
+    static_assert(ROWS == COLS, "The symmetry reduction needs a square board");
+    typedef BOARD_T<ROWS, COLS, K> BOARD;
+    typedef SYMMETRY_T<ROWS> SYMMETRY;
+    static constexpr int CELLS = ROWS * COLS;
+    // Score of a win, the search depth is taken from it to prefer faster wins (10 on 3x3)
+    static constexpr int WIN_SCORE = CELLS + 1;
+    // The shared cache covers every 3x3 position, bigger boards do not use it
+    static constexpr int CACHE_SIZE = BOARD::CLASSIC ? 19683 : 1;
 
-class Optimal_algorithm{
     private:
-        int evaluate(BOARD &b, char player, char opponent){
-        // Checking for Rows for X or O victory.
-        for(int row = 0; row<3; row++){
-            if(b.get_cell(row, 0) == b.get_cell(row, 1) &&
-                b.get_cell(row, 1) == b.get_cell(row, 2))
-            {
-                if(b.get_cell(row, 0) == player)
-                    return +10;
-                else if(b.get_cell(row,0) == opponent)
-                    return -10;
-            }
-        }
-        // Checking for Columns for X or O victory.
-        for(int col = 0; col<3; col++){
-            if(b.get_cell(0, col) == b.get_cell(1, col) &&
-                b.get_cell(1, col) == b.get_cell(2, col))
-            {
-                if(b.get_cell(0, col) == player)
-                    return +10;
-                else if(b.get_cell(0, col) == opponent)
-                    return -10;
-            }
-        }
-
-        // Checking for Diagonals for X or O victory.
-        if(b.get_cell(0,0) == b.get_cell(1,1) && 
-            b.get_cell(1,1) == b.get_cell(2,2))
-        {
-            if(b.get_cell(0, 0) == player)
-                return +10;
-            else if(b.get_cell(0,0) == opponent)
-                return -10;
-        }
-
-        if(b.get_cell(0,2) == b.get_cell(1,1) && 
-            b.get_cell(1,1) == b.get_cell(2,0))
-        {
-            if(b.get_cell(0,2) == player)
-                return +10;
-            else if(b.get_cell(0,2) == opponent)
-                return -10;
-        }
-        
-        // Else if none of them have won then return 0
+    static constexpr array<int, CELLS> cell_priority = build_cell_priority<ROWS, COLS, K>();
+    // Two killer moves (cells that caused a cutoff) for each search depth
+    short killers[CELLS + 1][2];
+    // Cutoff history of each cell for the maximizer [0] and the minimizer [1]
+    int history[2][CELLS];
+    // Number of positions visited by the current findBestMove call
+    long long nodes;
+
+    // Win score of the parallel search, a win found 'ply' moves below the root scores MATE - ply
+    static constexpr int MATE = 1 << 20;
+
+    // State shared by the workers of one parallel findBestMove call
+    struct SMP_SHARED {
+        atomic<bool> stop;
+        atomic<long long> nodes;
+        atomic<int> best;           // (completed depth << 8) | best cell, -1 if no depth completed
+        chrono::steady_clock::time_point start;
+        double time_budget_ms;
+        long long node_budget;
+    };
+    // Parallel search this instance is working for, NULL in the exhaustive search
+    SMP_SHARED* smp;
+    // Nodes visited since they were last added to smp->nodes
+    long long smp_pending;
+
+    /* Process-wide cache of solved positions, shared by every instance and thread.
+    It is indexed by [algorithm is 'O'][base-3 board code] and each entry packs
+    bit 31 = valid, bits 8-11 = best cell and bits 0-7 = best value + 128.
+    Every writer stores the same result for a position, so relaxed atomics are enough*/
+    static inline atomic<uint32_t> cache[2][CACHE_SIZE];
+
+    /*Returns +WIN_SCORE if 'player' completed a line, -WIN_SCORE if 'opponent' did
+    and 0 otherwise. The winner is read from the board's terminal table*/
+    int evaluate(BOARD &b, char player, char opponent){
+        char winner = b.get_winner();
+        if(winner == player)
+            return +WIN_SCORE;
+        else if(winner == opponent)
+            return -WIN_SCORE;
         return 0;
     }
 
     /*This is the minimax function. It considers all
     the possible ways the game can go and returns
     the value of the board*/
-    int minimax(BOARD board, int depth, bool isMax, char algorithm, char bot){
+    int minimax(BOARD &board, int depth, bool isMax, char algorithm, char bot){
+        nodes++;
         int score = evaluate(board, algorithm, bot);
         
         /*If Maximizer has won the game return his/her
         evaluated score*/
-        if(score == 10)
+        if(score == WIN_SCORE)
             return score - depth;
 
         /*If Minimizer has won the game return his/her
         evaluated score*/
-        if(score == -10)
+        if(score == -WIN_SCORE)
             return score + depth;
         /*If there are no more moves and no winner then
         it is a tie*/
         if(!board.isMoveLeft())
             return 0;
 
+        // Moves that lead to symmetric positions have the same value
+        short moves[CELLS];
+        int count = SYMMETRY::representative_moves(board.grid, moves);
+
         // If this maximizer's move
         if(isMax){
             int best = -1000;
 
-            // Traverse all cells
-            for(int i = 0; i<3; i++){
-                for(int j = 0; j<3; j++){
+            // Traverse one empty cell of each class of symmetric moves
+            for(int m = 0; m < count; m++){
+                // Make the move
+                board.do_move(algorithm, moves[m]);
 
-                    // Check if cell is empty
-                    if(board.get_cell(i, j) == ' '){
-                        // Make the move
-                        BOARD nb = board;
-                        nb.make_move(algorithm, i, j);
+                // Call minimax recursively and choose
+                // the maximum value
+                best = max(best, minimax(board, depth+1, false, algorithm, bot));
 
-                         // Call minimax recursively and choose
-                        // the maximum value
-                        best = max(best, minimax(nb, depth+1, false, algorithm, bot));
-                    }
-                }
+                // Undo the move
+                board.undo_move(moves[m]);
             }
             return best;
         }
@@ -96,20 +127,121 @@ class Optimal_algorithm{
         else{
             int best = 1000;
 
-            // Traverse all cells
-            for(int i = 0; i<3; i++){
-                for(int j = 0; j<3; j++){
-                     // Check if cell is empty
-                    if(board.get_cell(i, j) == ' '){
-                        // Make the move
-                        BOARD nb = board;
-                        nb.make_move(bot, i, j);
+            // Traverse one empty cell of each class of symmetric moves
+            for(int m = 0; m < count; m++){
+                // Make the move
+                board.do_move(bot, moves[m]);
+
+                // Call minimax recursively and choose
+                // the minimum value
+                best = min(best, minimax(board, depth+1, true, algorithm, bot));
+
+                // Undo the move
+                board.undo_move(moves[m]);
+            }
+            return best;
+        }
+    }
+
+    /**
+     * @brief Orders the empty cells of the board for the alpha-beta search.
+     * Only one cell of each class of symmetric moves is kept. Killer moves of the current depth come first, the rest is sorted by
+     * cutoff history and by the static cell priority (cells on more lines first).
+     * @param board the current board
+     * @param depth the current search depth
+     * @param isMax if the maximizer is the one moving
+     * @param order output array with the ordered cell indexes
+     * @return the number of cells written to 'order'
+     */
+    int order_moves(BOARD &board, int depth, bool isMax, short order[CELLS]){
+        short moves[CELLS];
+        int size = SYMMETRY::representative_moves(board.grid, moves);
+        int score[CELLS];
+        int count = 0;
+        for(int m = 0; m < size; m++){
+            short i = moves[m];
+            int s = history[!isMax][i] * 4 + cell_priority[i];
+            if(i == killers[depth][0])
+                s += 1 << 28;
+            else if(i == killers[depth][1])
+                s += 1 << 27;
+
+            // Insertion sort, the list holds at most CELLS cells
+            int k = count++;
+            while(k > 0 && score[k-1] < s){
+                score[k] = score[k-1];
+                order[k] = order[k-1];
+                k--;
+            }
+            score[k] = s;
+            order[k] = i;
+        }
+        return count;
+    }
+
+    /**
+     * @brief Clears the killer moves and the cutoff history.
+     */
+    void reset_heuristics(void){
+        for(auto& k : killers)
+            k[0] = k[1] = -1;
+        for(auto& h : history)
+            for(auto& cell : h)
+                cell = 0;
+    }
+
+    /**
+     * @brief Registers a move that caused a beta/alpha cutoff.
+     */
+    void store_cutoff(short cell, int depth, bool isMax){
+        if(killers[depth][0] != cell){
+            killers[depth][1] = killers[depth][0];
+            killers[depth][0] = cell;
+        }
+        history[!isMax][cell] += (CELLS - depth) * (CELLS - depth);
+    }
+
+    /*Alpha-beta version of minimax. It returns the same value as minimax
+    whenever that value lies inside (alpha, beta), and a bound outside of it
+    otherwise, so the root can only pick the same moves as the plain search*/
+    int alphabeta(BOARD &board, int depth, bool isMax, char algorithm, char bot, int alpha, int beta){
+        nodes++;
+        int score = evaluate(board, algorithm, bot);
 
+        if(score == WIN_SCORE)
+            return score - depth;
+        if(score == -WIN_SCORE)
+            return score + depth;
+        if(!board.isMoveLeft())
+            return 0;
 
-                        // Call minimax recursively and choose
-                        // the minimum value
-                        best = min(best, minimax(nb, depth+1, true, algorithm, bot));
-                    }
+        short order[CELLS];
+        int count = order_moves(board, depth, isMax, order);
+
+        if(isMax){
+            int best = -1000;
+            for(int m = 0; m < count; m++){
+                board.do_move(algorithm, order[m]);
+                best = max(best, alphabeta(board, depth+1, false, algorithm, bot, alpha, beta));
+                board.undo_move(order[m]);
+                alpha = max(alpha, best);
+                if(alpha >= beta){
+                    store_cutoff(order[m], depth, isMax);
+                    break;
+                }
+            }
+            return best;
+        }
+        else{
+            int best = 1000;
+            for(int m = 0; m < count; m++){
+                board.do_move(bot, order[m]);
+                best = min(best, alphabeta(board, depth+1, true, algorithm, bot, alpha, beta));
+                board.undo_move(order[m]);
+                beta = min(beta, best);
+                if(alpha >= beta){
+                    store_cutoff(order[m], depth, isMax);
+                    break;
                 }
             }
             return best;
@@ -121,36 +253,502 @@ public:
     struct Move {
         int row, col;
     };
+
+    // Optional report of the work done by a findBestMove call
+    struct SearchStats {
+        long long nodes;    // Positions visited by the search
+        double time_ms;     // Wall time spent in the search, in milliseconds
+        bool cached;        // If the move came from the shared cache
+        int depth;          // Depth completed by the parallel search (0 for the exhaustive search)
+    };
+
+private:
+    /* ---------------- Parallel (Lazy SMP) search ----------------
+    Used when 'threads' > 0, for boards too big to solve on one thread.
+    Every worker runs iterative deepening alpha-beta (in negamax form) on its
+    own copy of the board. They only share the transposition table, so each
+    worker finds the positions already searched by the others, and the first
+    one to complete a depth publishes its move. The search stops when the game
+    is solved or the time/node budget runs out, returning the best move so far*/
+
+    /**
+     * @brief Process-wide transposition table of this board size, shared by every thread.
+     */
+    static TRANSPOSITION_TABLE& table(){
+        static TRANSPOSITION_TABLE tt(TT_SIZE_LOG2);
+        return tt;
+    }
+
+    /**
+     * @brief Hashes the position (both bitboards and the side to move) into a table key.
+     */
+    static uint64_t position_key(const BOARD &board, char to_move){
+        return position_key(board.get_bits(0), board.get_bits(1), to_move);
+    }
+    static uint64_t position_key(uint64_t x_bits, uint64_t o_bits, char to_move){
+        uint64_t x = x_bits * 0x9E3779B97F4A7C15ULL ^ o_bits * 0xC2B2AE3D27D4EB4FULL;
+        if(to_move == 'O')
+            x ^= 0x165667B19E3779F9ULL;
+        // splitmix64 finalizer
+        x ^= x >> 30; x *= 0xBF58476D1CE4E5B9ULL;
+        x ^= x >> 27; x *= 0x94D049BB133111EBULL;
+        x ^= x >> 31;
+        return x ? x : 1;
+    }
+
+    /**
+     * @brief Scores a position the search did not finish, from the point of view of 'me'.
+     * Every line still open for one player only is worth 8^(stones - 1) to that player.
+     */
+    int heuristic(BOARD &board, char me){
+        uint64_t mine = board.get_bits(me == 'O'), theirs = board.get_bits(me != 'O');
+        int score = 0;
+        for(auto mask : BOARD::line_masks){
+            int a = __builtin_popcountll(mine & mask), b = __builtin_popcountll(theirs & mask);
+            if(b == 0 && a > 0)
+                score += 1 << (3 * (a - 1));
+            else if(a == 0 && b > 0)
+                score -= 1 << (3 * (b - 1));
+        }
+        return score;
+    }
+
+    // Win scores are stored relative to the position, not to the root
+    static int to_table(int score, int ply){
+        return score > MATE - 256 ? score + ply : score < 256 - MATE ? score - ply : score;
+    }
+    static int from_table(int score, int ply){
+        return score > MATE - 256 ? score - ply : score < 256 - MATE ? score + ply : score;
+    }
+
+    /**
+     * @brief Adds the pending nodes to the shared counter and stops the search when a budget is spent.
+     */
+    void check_budget(void){
+        long long total = smp->nodes.fetch_add(smp_pending, memory_order_relaxed) + smp_pending;
+        smp_pending = 0;
+        if(smp->node_budget > 0 && total >= smp->node_budget)
+            smp->stop.store(true, memory_order_relaxed);
+        if(smp->time_budget_ms > 0 &&
+            chrono::duration<double, milli>(chrono::steady_clock::now() - smp->start).count() >= smp->time_budget_ms)
+            smp->stop.store(true, memory_order_relaxed);
+    }
+
+    /**
+     * @brief Depth-limited alpha-beta in negamax form for the parallel search.
+     * @param board the board, shared by the whole recursion of this worker
+     * @param depth remaining depth, the heuristic is used when it reaches 0
+     * @param ply distance from the root
+     * @param me the player to move, scores are from its point of view
+     * @param opp the other player
+     * @return the score, meaningless if the search was stopped
+     */
+    int negamax(BOARD &board, int depth, int ply, int alpha, int beta, char me, char opp){
+        nodes++;
+        if(++smp_pending == 1024)
+            check_budget();
+        if(smp->stop.load(memory_order_relaxed))
+            return 0;
+
+        // Only the player who just moved can have completed a line
+        if(board.get_winner() != EMPTY_CELL)
+            return -(MATE - ply);
+        if(!board.isMoveLeft())
+            return 0;
+        // A position of the endgame table is solved, a win of unknown length ranks below every proven one
+        if(endgame != NULL){
+            int value = endgame->probe(board.get_bits(me == 'O'), board.get_bits(opp == 'O'));
+            if(value == EGTB_WIN)
+                return MATE - 128 - ply;
+            if(value == EGTB_LOSS)
+                return -(MATE - 128 - ply);
+            if(value == EGTB_DRAW)
+                return 0;
+        }
+        if(depth == 0)
+            return heuristic(board, me);
+
+        uint64_t key = position_key(board, me);
+        int alpha_orig = alpha;
+        short tt_cell = -1;
+        TRANSPOSITION_TABLE::ENTRY entry;
+        if(table().probe(key, entry)){
+            tt_cell = entry.cell;
+            if(entry.depth >= depth){
+                int score = from_table(entry.score, ply);
+                if(entry.bound == TT_EXACT)
+                    return score;
+                if(entry.bound == TT_LOWER && score >= beta)
+                    return score;
+                if(entry.bound == TT_UPPER && score <= alpha)
+                    return score;
+            }
+        }
+
+        short order[CELLS];
+        int count = order_moves(board, ply, me == 'X', order);
+        // The best move stored in the table goes first
+        for(int m = 1; m < count; m++)
+            if(order[m] == tt_cell)
+                rotate(order, order + m, order + m + 1);
+
+        int best = -MATE - 1;
+        short best_cell = order[0];
+        for(int m = 0; m < count; m++){
+            board.do_move(me, order[m]);
+            int score = -negamax(board, depth - 1, ply + 1, -beta, -alpha, opp, me);
+            board.undo_move(order[m]);
+            if(smp->stop.load(memory_order_relaxed))
+                return 0;
+
+            if(score > best){
+                best = score;
+                best_cell = order[m];
+            }
+            alpha = max(alpha, best);
+            if(alpha >= beta){
+                store_cutoff(order[m], ply, me == 'X');
+                break;
+            }
+        }
+
+        short bound = best <= alpha_orig ? TT_UPPER : best >= beta ? TT_LOWER : TT_EXACT;
+        table().store(key, to_table(best, ply), best_cell, depth, bound);
+        return best;
+    }
+
+    /**
+     * @brief Iterative deepening loop run by every thread of the parallel search.
+     * @param board a private copy of the position
+     * @param id the worker's number, helpers start at odd depths and rotate the root moves
+     */
+    void smp_worker(BOARD board, char me, char opp, int id){
+        short root[CELLS];
+        int count = SYMMETRY::representative_moves(board.grid, root);
+        if(count > 1)
+            rotate(root, root + id % count, root + count);
+        int max_depth = CELLS - board.get_used_cells();
+
+        for(int depth = 1 + (id & 1); depth <= max_depth; depth++){
+            int alpha = -MATE - 1, best = -MATE - 1;
+            short best_cell = -1;
+            for(int m = 0; m < count; m++){
+                board.do_move(me, root[m]);
+                int score = -negamax(board, depth - 1, 1, -MATE - 1, -alpha, opp, me);
+                board.undo_move(root[m]);
+                if(smp->stop.load(memory_order_relaxed))
+                    break;
+                if(score > best){
+                    best = score;
+                    best_cell = root[m];
+                }
+                alpha = max(alpha, best);
+            }
+            if(smp->stop.load(memory_order_relaxed))
+                break;
+
+            // Publishes the move of the deepest completed depth; at equal depth the lowest cell
+            // wins, so the move of a depth does not depend on which worker finished it first
+            int published = smp->best.load(memory_order_relaxed);
+            int mine = (depth << 8) | best_cell;
+            auto replaces = [&](int p) { return (p >> 8) < depth || ((p >> 8) == depth && (p & 0xFF) > best_cell); };
+            while(replaces(published) && !smp->best.compare_exchange_weak(published, mine, memory_order_relaxed));
+
+            // The next iteration starts from the best move
+            for(int m = 1; m < count; m++)
+                if(root[m] == best_cell)
+                    rotate(root, root + m, root + m + 1);
+
+            // A forced win or loss needs no deeper search
+            if(depth == max_depth || best > MATE - 256 || best < 256 - MATE)
+                smp->stop.store(true, memory_order_relaxed);
+        }
+        smp->nodes.fetch_add(smp_pending, memory_order_relaxed);
+        smp_pending = 0;
+    }
+
+    /**
+     * @brief Picks a move from the endgame table: a move that wins at once, then the one
+     * that leaves the opponent lost the soonest, then one that draws, and when every move
+     * loses the one that holds out the longest (other ties in row-major order).
+     * @return the cell, or -1 if the children of the position are not in the table
+     */
+    short endgame_move(BOARD &board, char algorithm, char bot){
+        if(endgame == NULL || !endgame->covers(board.get_used_cells() + 1) || board.get_winner() != EMPTY_CELL)
+            return -1;
+        // Rank of each child value for the mover, lower is better
+        const int rank[4] = {4, 3, 2, 1};
+        short best_cell = -1;
+        int best_key = 5 * 256;
+        for(short cell = 0; cell < CELLS; cell++){
+            if(board.grid[cell] != EMPTY_CELL)
+                continue;
+            board.do_move(algorithm, cell);
+            nodes++;
+            uint64_t mover = board.get_bits(bot == 'O'), other = board.get_bits(algorithm == 'O');
+            int child_rank = board.get_winner() == algorithm ? 0 : rank[endgame->probe(mover, other)];
+            // The fastest win and the slowest loss: the distance of the child breaks ties
+            int plies = child_rank == 1 || child_rank == 3 ? endgame->distance(mover, other) : 0;
+            board.undo_move(cell);
+            if(child_rank == 4)
+                return -1;
+            int key = child_rank * 256 + (child_rank == 3 ? 255 - plies : plies);
+            if(key < best_key){
+                best_key = key;
+                best_cell = cell;
+            }
+        }
+        return best_cell;
+    }
+
+    /**
+     * @brief Runs the parallel search with 'threads' workers.
+     */
+    Move parallel_search(BOARD &board, char algorithm, char bot, SearchStats *stats){
+        SMP_SHARED shared;
+        shared.stop = false;
+        shared.nodes = 0;
+        shared.best = -1;
+        shared.start = chrono::steady_clock::now();
+        shared.time_budget_ms = time_budget_ms;
+        shared.node_budget = node_budget;
+
+        vector<Optimal_algorithm_T> workers(threads, Optimal_algorithm_T(symbol));
+        vector<thread> pool;
+        for(int id = 0; id < threads; id++){
+            workers[id].smp = &shared;
+            workers[id].endgame = endgame;
+            workers[id].smp_pending = 0;
+            workers[id].reset_heuristics();
+        }
+        for(int id = 1; id < threads; id++)
+            pool.emplace_back(&Optimal_algorithm_T::smp_worker, &workers[id], board, algorithm, bot, id);
+        workers[0].smp_worker(board, algorithm, bot, 0);
+        for(auto& t : pool)
+            t.join();
+
+        int best = shared.best.load();
+        short cell;
+        if(best >= 0)
+            cell = best & 0xFF;
+        else{
+            // Out of budget before depth 1: falls back to the first ordered move
+            short order[CELLS];
+            reset_heuristics();
+            if(order_moves(board, 0, true, order) == 0)
+                return {-1, -1};
+            cell = order[0];
+        }
+
+        if(stats != NULL){
+            stats->nodes = shared.nodes.load();
+            stats->cached = false;
+            stats->depth = best >= 0 ? best >> 8 : 0;
+            stats->time_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - shared.start).count();
+        }
+        return {cell / COLS, cell % COLS};
+    }
+
+public:
+
     char symbol;
-    Optimal_algorithm(char symbol = 'O') : symbol(symbol){}
+    // Uses alpha-beta pruning with move ordering instead of plain minimax
+    bool alpha_beta;
+    // Reads and fills the process-wide cache of solved positions
+    bool use_cache;
+    // Worker threads of the parallel search, 0 runs the exhaustive single-thread search
+    int threads;
+    // Budgets of the parallel search, 0 means unlimited
+    double time_budget_ms;
+    long long node_budget;
+    // Solved positions read from a mapped endgame table, NULL to search every position
+    const ENDGAME_TABLE_T<ROWS, COLS, K>* endgame;
+    Optimal_algorithm_T(char symbol = 'O', bool alpha_beta = true, bool use_cache = true)
+        : nodes(0), smp(NULL), smp_pending(0), symbol(symbol), alpha_beta(alpha_beta),
+          use_cache(use_cache && BOARD::CLASSIC), threads(0), time_budget_ms(0), node_budget(0), endgame(NULL){
+        reset_heuristics();
+    }
 
     // This will return the best possible move
-    Move findBestMove(BOARD &board, char algorithm, char bot){
+    Move findBestMove(BOARD &board, char algorithm, char bot, SearchStats *stats = NULL){
+        auto start = chrono::steady_clock::now();
+        nodes = 0;
+
+        // Positions covered by the endgame table need no search
+        short table_cell = endgame_move(board, algorithm, bot);
+        if(table_cell != -1){
+            if(stats != NULL){
+                stats->nodes = nodes;
+                stats->cached = true;
+                stats->depth = 0;
+                stats->time_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+            }
+            return {table_cell / COLS, table_cell % COLS};
+        }
+
+        if(threads > 0)
+            return parallel_search(board, algorithm, bot, stats);
+
         int bestVal = -1000;
         Move bestMove = {-1, -1};
 
-        /*Traverse all cells, evaluate minimax function for
-        all empty cells. And return the cell with optimal value.*/
-        for(int i = 0; i<3; i++){
-            for(int j = 0; j<3; j++){
-                // Check if cell is empty
-                if(board.get_cell(i, j) == ' '){
-                    // Make the move
-                    BOARD nb = board;
-                    nb.make_move(algorithm, i, j);
-
-                    // compute evaluation function for this move.
-                    int moveVal = minimax(nb, 0, false, algorithm, bot);
-
-                    /*If the value of the current move is 
-                    more than the best value, then update best*/
-                    if(moveVal > bestVal){
-                        bestVal = moveVal;
-                        bestMove = {i, j};
-                    }
+        // A solved position costs a single probe
+        int code = (int)(board.get_code() % CACHE_SIZE);
+        if(use_cache){
+            uint32_t entry = cache[algorithm == 'O'][code].load(memory_order_relaxed);
+            if(entry >> 31){
+                int cell = (entry >> 8) & 0xF;
+                if(stats != NULL){
+                    stats->nodes = 0;
+                    stats->cached = true;
+                    stats->depth = 0;
+                    stats->time_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
                 }
+                return {cell / COLS, cell % COLS};
             }
         }
+
+        reset_heuristics();
+
+        /*Traverse one empty cell of each class of symmetric moves,
+        evaluate minimax function for them and return the cell with optimal value.
+        The representatives are the lowest cells of their class in the real
+        orientation of the board, so the chosen move needs no mapping back and
+        ties are broken in row-major order as before*/
+        short moves[CELLS];
+        int count = SYMMETRY::representative_moves(board.grid, moves);
+        for(int m = 0; m < count; m++){
+            // Make the move, the same board is used by the whole search
+            board.do_move(algorithm, moves[m]);
+            nodes++;
+
+            // compute evaluation function for this move.
+            int moveVal;
+            if(alpha_beta)
+                moveVal = alphabeta(board, 0, false, algorithm, bot, bestVal, 1000);
+            else
+                moveVal = minimax(board, 0, false, algorithm, bot);
+
+            // Undo the move
+            board.undo_move(moves[m]);
+
+            /*If the value of the current move is 
+            more than the best value, then update best*/
+            if(moveVal > bestVal){
+                bestVal = moveVal;
+                bestMove = {moves[m] / COLS, moves[m] % COLS};
+            }
+        }
+
+        if(use_cache && bestMove.row != -1){
+            uint32_t entry = (1u << 31) | ((bestMove.row*COLS + bestMove.col) << 8) | (bestVal + 128);
+            cache[algorithm == 'O'][code].store(entry, memory_order_relaxed);
+        }
+
+        if(stats != NULL){
+            stats->nodes = nodes;
+            stats->cached = false;
+            stats->depth = 0;
+            stats->time_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        }
         return bestMove;
     }
+
+    /**
+     * @brief Saves every solved position of the shared cache to a text file.
+     * Each line holds: board code, symbol to move, best cell and best value.
+     * @param filename The name of the file to save to.
+     * @return true if saving was successful, false otherwise.
+     */
+    static bool save_cache(const string& filename){
+        ofstream file(filename);
+        if(!file.is_open()){
+            cerr << "Error: Could not open file for writing: " << filename << endl;
+            return false;
+        }
+
+        for(int side = 0; side < 2; side++){
+            for(int code = 0; code < CACHE_SIZE; code++){
+                uint32_t entry = cache[side][code].load(memory_order_relaxed);
+                if(entry >> 31)
+                    file << code << " " << (side ? 'O' : 'X') << " " << ((entry >> 8) & 0xF)
+                         << " " << (int)(entry & 0xFF) - 128 << "\n";
+            }
+        }
+
+        file.close();
+        return true;
+    }
+
+    /**
+     * @brief Warms the shared cache up with positions solved by a previous run.
+     * @param filename The name of the file written by save_cache.
+     * @return true if loading was successful, false otherwise.
+     */
+    static bool load_cache(const string& filename){
+        ifstream file(filename);
+        if(!file.is_open()){
+            cout << "Info: Could not open file for reading: " << filename << ". Starting with an empty minimax cache." << endl;
+            return false;
+        }
+
+        string line;
+        int line_count = 0;
+        while(getline(file, line)){
+            line_count++;
+            stringstream ss(line);
+            int code, cell, value;
+            char side;
+            if(!(ss >> code >> side >> cell >> value) || code < 0 || code >= CACHE_SIZE ||
+                (side != 'X' && side != 'O') || cell < 0 || cell >= CELLS || value < -128 || value > 127){
+                cerr << "Warning: Skipping malformed line " << line_count << ": " << line << endl;
+                continue;
+            }
+            uint32_t entry = (1u << 31) | (cell << 8) | (value + 128);
+            cache[side == 'O'][code].store(entry, memory_order_relaxed);
+        }
+
+        file.close();
+        return true;
+    }
+
+    /**
+     * @brief Seeds the transposition table of the parallel search with the positions
+     * solved by PN_SOLVER_T::save_solved. Every rotation and flip of a position is stored,
+     * with either symbol to move, as an exact result no search depth can replace.
+     * @param filename The name of the file written by save_solved.
+     * @return the number of positions read, -1 if the file is missing or for another board
+     */
+    static int load_solved(const string& filename){
+        ifstream file(filename);
+        if(!file.is_open()){
+            cout << "Info: Could not open file for reading: " << filename << ". Starting without solved positions." << endl;
+            return -1;
+        }
+        int rows, cols, k;
+        if(!(file >> rows >> cols >> k) || rows != ROWS || cols != COLS || k != K){
+            cerr << "Error: " << filename << " was not solved for this board" << endl;
+            return -1;
+        }
+
+        int count = 0;
+        uint64_t mover, other;
+        int value;
+        while(file >> mover >> other >> value){
+            if(value != EGTB_WIN && value != EGTB_DRAW && value != EGTB_LOSS)
+                continue;
+            int score = value == EGTB_WIN ? MATE - 128 : value == EGTB_LOSS ? -(MATE - 128) : 0;
+            for(int t = 0; t < 8; t++){
+                uint64_t m = SYMMETRY::transform_bits(mover, t), o = SYMMETRY::transform_bits(other, t);
+                table().store(position_key(m, o, 'X'), score, -1, CELLS, TT_EXACT);
+                table().store(position_key(o, m, 'O'), score, -1, CELLS, TT_EXACT);
+            }
+            count++;
+        }
+
+        file.close();
+        return count;
+    }
 };
+
+typedef Optimal_algorithm_T<3, 3, 3> Optimal_algorithm;
@@ -0,0 +1,138 @@
+#ifndef PHILOX_CPP
+#define PHILOX_CPP
+
+#include <cstdint>
+#include <limits>
+using namespace std;
+
+// Individual coordinate of the draws made for the whole population (shuffles, selections)
+#define PHILOX_POPULATION 0xFFFFFFFFu
+// Game coordinate of the draws that mutate an individual's child
+#define PHILOX_MUTATION 0xFFFFFFFFu
+
+/**
+ * @class PHILOX
+ * @brief Counter-based random numbers (Philox4x32-10): every number is a function of a
+ * key and a position, so there is no state to share or to lock.
+ *
+ * The key is the run's 64-bit seed and the position is (generation, individual, game,
+ * ply, draw), one 32-bit counter word for each of the first three and the last word
+ * split into ply (12 bits) and block of 4 draws (20 bits). The same seed and position
+ * give the same numbers whatever thread or process draws them and in any order, which
+ * makes parallel runs reproducible. PHILOX meets the UniformRandomBitGenerator
+ * requirements, so it works with the <random> distributions.
+ */
+class PHILOX {
+    static constexpr uint32_t M0 = 0xD2511F53, M1 = 0xCD9E8D57;
+    static constexpr uint32_t W0 = 0x9E3779B9, W1 = 0xBB67AE85;
+
+    private:
+    uint32_t key[2];
+    uint32_t counter[4];
+    uint32_t block[4];
+    int used;
+
+    static void mulhilo(uint32_t a, uint32_t b, uint32_t& hi, uint32_t& lo) {
+        uint64_t product = (uint64_t)a * b;
+        hi = product >> 32;
+        lo = (uint32_t)product;
+    }
+
+    void generate(void) {
+        uint32_t c[4] = {counter[0], counter[1], counter[2], counter[3]};
+        uint32_t k0 = key[0], k1 = key[1];
+        for(int round = 0; round < 10; round++) {
+            uint32_t hi0, lo0, hi1, lo1;
+            mulhilo(M0, c[0], hi0, lo0);
+            mulhilo(M1, c[2], hi1, lo1);
+            uint32_t next[4] = {hi1 ^ c[1] ^ k0, lo1, hi0 ^ c[3] ^ k1, lo0};
+            for(int i = 0; i < 4; i++)
+                c[i] = next[i];
+            k0 += W0;
+            k1 += W1;
+        }
+        for(int i = 0; i < 4; i++)
+            block[i] = c[i];
+        used = 0;
+        // Next block of the same ply
+        counter[0] = (counter[0] & 0xFFF00000u) | ((counter[0] + 1) & 0x000FFFFFu);
+    }
+
+    public:
+    typedef uint32_t result_type;
+
+    static constexpr result_type min(void) {
+        return 0;
+    }
+
+    static constexpr result_type max(void) {
+        return numeric_limits<uint32_t>::max();
+    }
+
+    PHILOX(uint64_t seed = 0, uint32_t generation = 0, uint32_t individual = 0, uint32_t game = 0) {
+        set_seed(seed);
+        seek(generation, individual, game);
+    }
+
+    void set_seed(uint64_t seed) {
+        key[0] = (uint32_t)seed;
+        key[1] = (uint32_t)(seed >> 32);
+        used = 4;
+    }
+
+    uint64_t get_seed(void) const {
+        return (uint64_t)key[1] << 32 | key[0];
+    }
+
+    uint32_t get_game(void) const {
+        return counter[1];
+    }
+
+    /**
+     * @brief Moves to the first draw of a game.
+     */
+    void seek(uint32_t generation, uint32_t individual, uint32_t game = 0) {
+        counter[3] = generation;
+        counter[2] = individual;
+        counter[1] = game;
+        counter[0] = 0;
+        used = 4;
+    }
+
+    /**
+     * @brief Moves to the first draw of the next game of the same individual.
+     */
+    void next_game(void) {
+        counter[1]++;
+        counter[0] = 0;
+        used = 4;
+    }
+
+    /**
+     * @brief Moves to the first draw of a ply of the current game.
+     */
+    void set_ply(uint32_t ply) {
+        counter[0] = (ply & 0xFFFu) << 20;
+        used = 4;
+    }
+
+    result_type operator()(void) {
+        if(used == 4)
+            generate();
+        return block[used++];
+    }
+
+    uint64_t next64(void) {
+        uint64_t high = (*this)();
+        return high << 32 | (*this)();
+    }
+
+    /**
+     * @brief A number in [0, bound), for bound > 0.
+     */
+    uint64_t below(uint64_t bound) {
+        return next64() % bound;
+    }
+};
+
+#endif // PHILOX_CPP
@@ -1,8 +1,30 @@
+#ifndef PLAY_CPP
+#define PLAY_CPP
+
 #include "Board.h"
 #include "Bot.cpp"
 #include "Optimal_algorithm.cpp"
+#include "Mcts.cpp"
+#include "Ntuple_bot.cpp"
+#include "Game_log.cpp"
+
+// When the runners end a game before a line is complete or the board is full (BOARD_T::classify)
+#define EARLY_OFF 0         // Never: every game is played to the end
+#define EARLY_DRAWS 1       // At a dead draw (no line can be completed by either player)
+#define EARLY_FORCED 2      // At a dead draw, a win in one move or an unstoppable double threat
+
+/**
+ * @class TicTacToeMiniMax_T
+ * @brief Plays a BOT against a search teacher. The teacher is the minimax by default,
+ * and any class with the same findBestMove interface (like MCTS_T) can take its place.
+ * The learner is a BOT_T by default, and NTUPLE_BOT_T can take its place.
+ */
+template<int ROWS, int COLS, int K, class TEACHER = Optimal_algorithm_T<ROWS, COLS, K>, class PLAYER = BOT_T<ROWS, COLS, K>>
+class TicTacToeMiniMax_T{
+    typedef BOARD_T<ROWS, COLS, K> BOARD;
+    typedef PLAYER BOT;
+    typedef TEACHER Optimal_algorithm;
 
-class TicTacToeMiniMax{
     private:
     bool curr_player; // 0 = P1, 1 = P2
     BOARD board;
@@ -18,18 +40,27 @@ class TicTacToeMiniMax{
     }
 
     public:
+    // Every finished game is appended here when it is not NULL
+    GAME_LOG_WRITER_T<ROWS, COLS, K>* game_log;
+    // EARLY_OFF, EARLY_DRAWS or EARLY_FORCED. A game ended early credits its result to the
+    // moves already played, the ones that led to it
+    int early_end;
+    // Moves played and games ended early so far
+    long long plies, early_games;
+
     // Construtor: Recebe o BOT e o Minimax por referência.
-    TicTacToeMiniMax(BOT& bot, Optimal_algorithm& minimax) 
-        : curr_player(0), board(), bot_ref(&bot), minimax_ref(&minimax) {}
+    TicTacToeMiniMax_T(BOT& bot, Optimal_algorithm& minimax) 
+        : curr_player(0), board(), bot_ref(&bot), minimax_ref(&minimax), game_log(NULL), early_end(EARLY_OFF), plies(0), early_games(0) {}
 
     /**
-     * @brief Roda um jogo onde o BOT pode ser P1 ('X') ou P2 ('O') contra o Minimax.
-     * @param bot_is_x: Se TRUE, BOT é 'X' e Minimax é 'O'. Se FALSE, BOT é 'O' e Minimax é 'X'.
+     * @brief Roda um jogo onde o BOT pode ser P1 ou P2 contra o Minimax.
+     * @param bot_is_x: Se TRUE, BOT é P1 ('X') e Minimax é P2 ('O'). Se FALSE, Minimax é P1 ('O') e BOT é P2 ('X').
      * @return short: O resultado do jogo (WIN, LOSS, DRAW) para o BOT evolutivo.
      */
     short run_game(bool bot_is_x, const bool& print = true) {
         P1_SYMBOL = bot_is_x ? 'X' : 'O'; // P1: BOT ou Minimax
         P2_SYMBOL = bot_is_x ? 'O' : 'X'; // P2: Minimax ou BOT
+        bot_ref->symbol = bot_is_x ? P1_SYMBOL : P2_SYMBOL; // O BOT avalia o tabuleiro do seu lado
         
         board.reset_board();
         bot_ref->clear_history();
@@ -37,6 +68,8 @@ class TicTacToeMiniMax{
 
         short result = DRAW;
         pair<short, short> move = {-1, -1};
+        uint8_t moves[ROWS * COLS];
+        int move_count = 0;
 
         while(true) {
             if(print) board.draw_board();
@@ -59,7 +92,7 @@ class TicTacToeMiniMax{
                 // Turnto do MINIMAX
                 // O Minimax precisa saber seu símbolo atual (current_symbol) e o do oponente.
                 char opponent_symbol = current_symbol == 'X' ? 'O' : 'X';
-                Optimal_algorithm::Move minimax_move = 
+                typename Optimal_algorithm::Move minimax_move = 
                     minimax_ref->findBestMove(board, current_symbol, opponent_symbol);
                 
                 move = {(short)minimax_move.row, (short)minimax_move.col};
@@ -70,6 +103,7 @@ class TicTacToeMiniMax{
             }
 
             board.make_move(current_symbol, move.first, move.second);
+            moves[move_count++] = (uint8_t)(move.first * COLS + move.second);
 
             // Checagem de vitória/empate
             if(board.check_win(move.first, move.second)) {
@@ -84,8 +118,29 @@ class TicTacToeMiniMax{
                 break;
             }
 
+            // Ends the game if its result is already certain
+            int outcome = early_end == EARLY_OFF ? ONGOING : board.classify(curr_player == 0 ? P2_SYMBOL : P1_SYMBOL);
+            if(outcome == DRAWN || (early_end == EARLY_FORCED && outcome != ONGOING)) {
+                char winner = outcome == X_WINS ? 'X' : 'O';
+                char bot_symbol = bot_is_x ? P1_SYMBOL : P2_SYMBOL;
+                result = outcome == DRAWN ? DRAW : winner == bot_symbol ? WIN : LOSS;
+                // The game log marks the winner as the player of the last move
+                curr_player = winner == P1_SYMBOL ? 0 : 1;
+                early_games++;
+                if(print) {
+                    board.draw_board();
+                    if(outcome == DRAWN) cout << "No line can be completed: it's a draw!\n";
+                    else cout << "Player " << winner << " wins by force!\n";
+                }
+                break;
+            }
+
             switch_player();
         }
+
+        plies += move_count;
+        if(game_log != NULL)
+            game_log->write(moves, move_count, result == DRAW ? LOG_DRAW : curr_player == 0 ? LOG_FIRST_WINS : LOG_SECOND_WINS, P1_SYMBOL);
         
         // APRENDIZADO DO BOT: O genoma do objeto original pop[i].first é atualizado.
         bot_ref->update_genomes(result);
@@ -95,11 +150,15 @@ class TicTacToeMiniMax{
 };
 
 /**
- * @class TicTacToeBOT
+ * @class TicTacToeBOT_T
  * @brief Handles the game's main loop. It allows auto-play to compete againt a bot
  * or have two bots compete against themselves
  */
-class TicTacToeBOT {
+template<int ROWS, int COLS, int K>
+class TicTacToeBOT_T {
+    typedef BOARD_T<ROWS, COLS, K> BOARD;
+    typedef BOT_T<ROWS, COLS, K> BOT;
+
     private:
     bool curr_player; // 0 = p0, 1 = p1
     BOARD board;
@@ -113,8 +172,14 @@ class TicTacToeBOT {
 
     public:
     array<BOT, 2> players; // Stores each player (BOT)
+    // Every finished game is appended here when it is not NULL
+    GAME_LOG_WRITER_T<ROWS, COLS, K>* game_log;
+    // EARLY_OFF, EARLY_DRAWS or EARLY_FORCED, as in TicTacToeMiniMax_T
+    int early_end;
+    // Moves played and games ended early so far
+    long long plies, early_games;
 
-    TicTacToeBOT(BOT& X, BOT& Y) : curr_player(0), board(), players{X, Y}{}
+    TicTacToeBOT_T(BOT& X, BOT& Y) : curr_player(0), board(), players{X, Y}, game_log(NULL), early_end(EARLY_OFF), plies(0), early_games(0) {}
 
     /**
      * @brief An auto-player between two bots competing against
@@ -130,6 +195,9 @@ class TicTacToeBOT {
         pair<short, short> move = {-1, -1};
         // Game's result
         short result = DRAW;
+        // Cell of every move, for the game log
+        uint8_t moves[ROWS * COLS];
+        int move_count = 0;
         
         // Main game loop
         while(true) {
@@ -149,6 +217,7 @@ class TicTacToeBOT {
             }
                 
             board.make_move(players[curr_player].symbol, move.first, move.second);
+            moves[move_count++] = (uint8_t)(move.first * COLS + move.second);
 
             // Stops the game if the current player won
             if(board.check_win(move.first, move.second)) {
@@ -173,13 +242,48 @@ class TicTacToeBOT {
                 break;
             }
 
+            // Stops the game if its result is already certain
+            int outcome = early_end == EARLY_OFF ? ONGOING : board.classify(players[!curr_player].symbol);
+            if(outcome == DRAWN || (early_end == EARLY_FORCED && outcome != ONGOING)) {
+                early_games++;
+                if(outcome == DRAWN) {
+                    if(print) {
+                        board.draw_board();
+                        cout << "No line can be completed: it's a draw!\n";
+                    }
+                    players[curr_player].update_genomes(DRAW);
+                    players[!curr_player].update_genomes(DRAW);
+                    break;
+                }
+                // The winner becomes the current player, as if it had just completed its line
+                char winner = outcome == X_WINS ? 'X' : 'O';
+                if(players[curr_player].symbol != winner)
+                    switch_player();
+                if(print) {
+                    board.draw_board();
+                    cout << "Player " << winner << " wins by force!\n";
+                }
+                players[curr_player].update_genomes(WIN);
+                players[!curr_player].update_genomes(LOSS);
+                result = winner == 'X' ? WIN : LOSS;
+                break;
+            }
+
             switch_player();
         }
+
+        plies += move_count;
+        if(game_log != NULL)
+            game_log->write(moves, move_count, result == DRAW ? LOG_DRAW : curr_player == 0 ? LOG_FIRST_WINS : LOG_SECOND_WINS, players[0].symbol);
         return result;
     }
 };
 
-class TicTacToePlayer{
+template<int ROWS, int COLS, int K>
+class TicTacToePlayer_T{
+    typedef BOARD_T<ROWS, COLS, K> BOARD;
+    typedef BOT_T<ROWS, COLS, K> BOT;
+
     private:
     bool curr_player; // 0 = P1, 1 = P2
     BOARD board;
@@ -195,7 +299,7 @@ class TicTacToePlayer{
 
     public:
     // Construtor: Recebe o BOT por referência.
-    TicTacToePlayer(BOT& bot) 
+    TicTacToePlayer_T(BOT& bot) 
         : curr_player(0), board(), bot_ref(&bot) {}
 
     /**
@@ -237,7 +341,7 @@ class TicTacToePlayer{
                 // Turnto do player
                 int x = -1, y = -1;
                 while(!board.valid_move(x, y)) {
-                    cout << "Choose a valid row (1-3) and a collumn (1-3)";
+                    cout << "Choose a valid row (1-" << ROWS << ") and a collumn (1-" << COLS << ")";
                     cin >> x >> y;
                     x --; y --;
                     
@@ -271,4 +375,10 @@ class TicTacToePlayer{
         bot_ref->update_genomes(result);
         return result;
     }
-};
\ No newline at end of file
+};
+
+typedef TicTacToeMiniMax_T<3, 3, 3> TicTacToeMiniMax;
+typedef TicTacToeBOT_T<3, 3, 3> TicTacToeBOT;
+typedef TicTacToePlayer_T<3, 3, 3> TicTacToePlayer;
+
+#endif // PLAY_CPP
@@ -0,0 +1,343 @@
+#ifndef PROOF_NUMBER_CPP
+#define PROOF_NUMBER_CPP
+
+#include <vector>
+#include <string>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <cstdint>
+#include "Board.h"
+#include "Symmetry.h"
+#include "Endgame_table.cpp"
+using namespace std;
+
+// Size of the proof-number transposition table (2^PN_TT_SIZE_LOG2 entries of 32 bytes)
+#define PN_TT_SIZE_LOG2 20
+// Nodes between two progress reports
+#define PN_REPORT_NODES 1000000
+
+/**
+ * @class PN_SOLVER_T
+ * @brief Depth-first proof-number search (df-pn) that finds the game-theoretic value of a position.
+ *
+ * One run answers "does the attacker win?": the nodes where the attacker moves are OR
+ * nodes, the others are AND nodes, and the search always expands the most-proving
+ * child within thresholds, like a best-first proof-number search that only keeps the
+ * current path on the stack. The value of a position takes two runs, one with each
+ * player as the attacker (neither proven means a draw).
+ *
+ * Positions are kept in their canonical form (the smallest of the 8 rotations and
+ * flips) and children that are symmetric to each other are expanded once. The table
+ * has a fixed size: each position goes to one of two slots and the entry that cost
+ * less work to compute is the one replaced.
+ */
+template<int ROWS, int COLS, int K>
+class PN_SOLVER_T {
+    static_assert(ROWS == COLS, "The symmetry reduction needs a square board");
+    typedef SYMMETRY_T<ROWS> SYMMETRY;
+    static constexpr int CELLS = ROWS * COLS;
+    static constexpr uint64_t ALL_CELLS = CELLS == 64 ? ~0ULL : (1ULL << CELLS) - 1;
+    static constexpr uint32_t INF = 1u << 30;
+    static constexpr auto line_masks = BOARD_T<ROWS, COLS, K>::line_masks;
+
+    private:
+    struct ENTRY {
+        uint64_t mover;         // Canonical cells of the player to move
+        uint64_t other;         // Canonical cells of the player who just moved
+        uint32_t pn, dn;        // Proof and disproof numbers
+        uint32_t work;          // Nodes spent on the position, 0 for an empty slot
+        bool attacker_moves;    // If the attacker is the player to move (OR node)
+    };
+
+    struct CHILD {
+        uint64_t mover, other;
+        bool terminal;
+        uint32_t pn, dn;        // Only meaningful for a terminal child
+    };
+
+    vector<ENTRY> table;
+    uint64_t mask;
+    long long nodes;
+    long long next_report;
+    bool stopped;
+    uint64_t root_mover, root_other;
+    bool root_attacker;
+    uint32_t root_pn, root_dn;  // Numbers of the root after its last iteration
+    long long used;             // Slots of the table in use
+    chrono::steady_clock::time_point start;
+
+    static bool has_line(uint64_t cells) {
+        for(auto line : line_masks)
+            if((cells & line) == line)
+                return true;
+        return false;
+    }
+
+    /**
+     * @brief Replaces the position with its smallest image under the 8 transforms.
+     */
+    static void canonical(uint64_t &mover, uint64_t &other) {
+        uint64_t best_mover = mover, best_other = other;
+        for(int t = 1; t < 8; t++) {
+            uint64_t m = SYMMETRY::transform_bits(mover, t), o = SYMMETRY::transform_bits(other, t);
+            if(m < best_mover || (m == best_mover && o < best_other)) {
+                best_mover = m;
+                best_other = o;
+            }
+        }
+        mover = best_mover;
+        other = best_other;
+    }
+
+    static uint64_t slot_hash(uint64_t mover, uint64_t other, bool attacker_moves) {
+        uint64_t x = mover * 0x9E3779B97F4A7C15ULL ^ other * 0xC2B2AE3D27D4EB4FULL ^ (attacker_moves ? 0x165667B19E3779F9ULL : 0);
+        x ^= x >> 30; x *= 0xBF58476D1CE4E5B9ULL;
+        x ^= x >> 27; x *= 0x94D049BB133111EBULL;
+        return x ^ (x >> 31);
+    }
+
+    const ENTRY* find(uint64_t mover, uint64_t other, bool attacker_moves) const {
+        uint64_t slot = slot_hash(mover, other, attacker_moves) & mask;
+        for(uint64_t s : {slot, slot ^ 1}) {
+            const ENTRY &e = table[s];
+            if(e.work != 0 && e.mover == mover && e.other == other && e.attacker_moves == attacker_moves)
+                return &e;
+        }
+        return NULL;
+    }
+
+    void store(uint64_t mover, uint64_t other, bool attacker_moves, uint32_t pn, uint32_t dn, long long work) {
+        uint64_t slot = slot_hash(mover, other, attacker_moves) & mask;
+        ENTRY *target = &table[slot];
+        ENTRY &pair = table[slot ^ 1];
+        bool same = target->work != 0 && target->mover == mover && target->other == other && target->attacker_moves == attacker_moves;
+        if(!same) {
+            if(pair.work != 0 && pair.mover == mover && pair.other == other && pair.attacker_moves == attacker_moves)
+                target = &pair;
+            else if(pair.work < target->work)
+                target = &pair;
+        }
+        used += target->work == 0;
+        *target = {mover, other, pn, dn, (uint32_t)min<long long>(max<long long>(work, 1), INF), attacker_moves};
+    }
+
+    /**
+     * @brief Proof and disproof numbers of a child: exact if terminal, from the table or 1/1 if unseen.
+     */
+    void child_numbers(const CHILD &c, bool attacker_moves, uint32_t &pn, uint32_t &dn) const {
+        if(c.terminal) {
+            pn = c.pn;
+            dn = c.dn;
+            return;
+        }
+        const ENTRY *e = find(c.mover, c.other, attacker_moves);
+        pn = e != NULL ? e->pn : 1;
+        dn = e != NULL ? e->dn : 1;
+    }
+
+    void report(void) {
+        if(nodes < next_report)
+            return;
+        next_report += PN_REPORT_NODES;
+        double elapsed = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        cout << "  " << nodes << " nodes, " << (root_attacker ? "win" : "loss") << " run, root pn " << root_pn << " dn " << root_dn
+             << ", table " << used * 100 / (long long)table.size() << "% full, "
+             << (long long)(nodes / max(elapsed, 1.0)) << " knodes/s\n";
+    }
+
+    /**
+     * @brief Expands a canonical position until its numbers reach a threshold.
+     * @param attacker_moves if the attacker is the player to move (OR node)
+     * @param ply distance from the root
+     * @param pn output with the position's proof number
+     * @param dn output with the position's disproof number
+     */
+    void mid(uint64_t mover, uint64_t other, bool attacker_moves, int ply, uint32_t thpn, uint32_t thdn, uint32_t &pn, uint32_t &dn) {
+        nodes++;
+        if(progress)
+            report();
+        if(node_budget > 0 && nodes >= node_budget)
+            stopped = true;
+        long long first_node = nodes;
+
+        // The player to move adds a stone, then the roles swap
+        short moves[CELLS];
+        int count = SYMMETRY::representative_moves(mover, other, moves);
+        CHILD children[CELLS];
+        for(int i = 0; i < count; i++) {
+            CHILD &c = children[i];
+            c.mover = other;
+            c.other = mover | (1ULL << moves[i]);
+            c.terminal = true;
+            if(has_line(c.other)) {
+                // The player who just moved won: proven if it is the attacker
+                c.pn = attacker_moves ? 0 : INF;
+                c.dn = attacker_moves ? INF : 0;
+            }
+            else if((c.mover | c.other) == ALL_CELLS) {
+                c.pn = INF;
+                c.dn = 0;
+            }
+            else {
+                c.terminal = false;
+                canonical(c.mover, c.other);
+            }
+        }
+
+        while(true) {
+            // OR nodes need one proven child, AND nodes need all of them
+            int best = 0;
+            uint32_t best_pn = INF, best_dn = INF, second = INF;
+            uint64_t sum = 0;
+            pn = attacker_moves ? INF : 0;
+            dn = attacker_moves ? 0 : INF;
+            for(int i = 0; i < count; i++) {
+                uint32_t cpn, cdn;
+                child_numbers(children[i], !attacker_moves, cpn, cdn);
+                uint32_t key = attacker_moves ? cpn : cdn;
+                if(key < (attacker_moves ? best_pn : best_dn)) {
+                    second = attacker_moves ? best_pn : best_dn;
+                    best = i;
+                    best_pn = cpn;
+                    best_dn = cdn;
+                }
+                else if(key < second)
+                    second = key;
+                sum += attacker_moves ? cdn : cpn;
+            }
+            if(attacker_moves) {
+                pn = best_pn;
+                dn = (uint32_t)min<uint64_t>(sum, INF);
+            }
+            else {
+                pn = (uint32_t)min<uint64_t>(sum, INF);
+                dn = best_dn;
+            }
+            if(ply == 0) {
+                root_pn = pn;
+                root_dn = dn;
+            }
+            if(pn >= thpn || dn >= thdn || stopped)
+                break;
+
+            uint32_t child_thpn, child_thdn;
+            if(attacker_moves) {
+                child_thpn = min(thpn, second + 1);
+                child_thdn = (uint32_t)min<uint64_t>((uint64_t)thdn - dn + best_dn, INF);
+            }
+            else {
+                child_thpn = (uint32_t)min<uint64_t>((uint64_t)thpn - pn + best_pn, INF);
+                child_thdn = min(thdn, second + 1);
+            }
+            uint32_t cpn, cdn;
+            mid(children[best].mover, children[best].other, !attacker_moves, ply + 1, child_thpn, child_thdn, cpn, cdn);
+        }
+        store(mover, other, attacker_moves, pn, dn, nodes - first_node + 1);
+    }
+
+    /**
+     * @brief Runs df-pn from the root with one of the players as the attacker.
+     * @return 1 if proven, 0 if disproven and -1 if the budget ran out
+     */
+    int prove(uint64_t mover, uint64_t other, bool attacker_moves) {
+        canonical(mover, other);
+        root_mover = mover;
+        root_other = other;
+        root_attacker = attacker_moves;
+        uint32_t pn = 1, dn = 1;
+        root_pn = root_dn = 1;
+        while(pn != 0 && dn != 0 && !stopped)
+            mid(mover, other, attacker_moves, 0, INF, INF, pn, dn);
+        return pn == 0 ? 1 : dn == 0 ? 0 : -1;
+    }
+
+    public:
+    // Nodes a solve() call may expand, 0 means unlimited
+    long long node_budget;
+    // Prints the search state every PN_REPORT_NODES nodes
+    bool progress;
+
+    PN_SOLVER_T(int size_log2 = PN_TT_SIZE_LOG2) : table(1ULL << size_log2), mask((1ULL << size_log2) - 1), nodes(0),
+        next_report(PN_REPORT_NODES), stopped(false), root_mover(0), root_other(0), root_attacker(true),
+        root_pn(1), root_dn(1), used(0), node_budget(0), progress(true) {
+        for(auto &e : table)
+            e = {0, 0, 0, 0, 0, false};
+    }
+
+    /**
+     * @brief Finds the value of a position with both players playing perfectly.
+     * @param mover cells of the player to move
+     * @param other cells of the player who just moved
+     * @return EGTB_WIN, EGTB_DRAW or EGTB_LOSS for the player to move, EGTB_UNKNOWN if the budget ran out
+     */
+    int solve(uint64_t mover, uint64_t other) {
+        start = chrono::steady_clock::now();
+        nodes = 0;
+        next_report = PN_REPORT_NODES;
+        stopped = false;
+        if(has_line(other))
+            return EGTB_LOSS;
+        if((mover | other) == ALL_CELLS)
+            return EGTB_DRAW;
+
+        int win = prove(mover, other, true);
+        if(win != 0)
+            return win == 1 ? EGTB_WIN : EGTB_UNKNOWN;
+        int loss = prove(mover, other, false);
+        return loss == 1 ? EGTB_LOSS : loss == 0 ? EGTB_DRAW : EGTB_UNKNOWN;
+    }
+
+    /**
+     * @brief Finds the value of a board for the player 'to_move'.
+     */
+    int solve(const BOARD_T<ROWS, COLS, K> &board, char to_move) {
+        return solve(board.get_bits(to_move == 'O'), board.get_bits(to_move != 'O'));
+    }
+
+    long long get_nodes(void) const {
+        return nodes;
+    }
+
+    double get_time_ms(void) const {
+        return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    }
+
+    /**
+     * @brief Saves every position whose value the table holds, for Optimal_algorithm_T::load_solved.
+     * The first line holds ROWS, COLS and K, then each line holds the canonical cells of the
+     * player to move, the cells of the other player and the value for the player to move
+     * (EGTB_WIN, EGTB_DRAW or EGTB_LOSS). A draw needs both runs disproven, so it is only
+     * written for positions still holding both entries.
+     * @param filename The name of the file to save to.
+     * @return true if saving was successful, false otherwise.
+     */
+    bool save_solved(const string& filename) const {
+        ofstream file(filename);
+        if(!file.is_open()) {
+            cerr << "Error: Could not open file for writing: " << filename << endl;
+            return false;
+        }
+
+        file << ROWS << " " << COLS << " " << K << "\n";
+        for(auto &e : table) {
+            if(e.work == 0)
+                continue;
+            int value = EGTB_UNKNOWN;
+            if(e.pn == 0)
+                value = e.attacker_moves ? EGTB_WIN : EGTB_LOSS;
+            else if(e.dn == 0 && e.attacker_moves) {
+                const ENTRY *defence = find(e.mover, e.other, false);
+                if(defence != NULL && defence->dn == 0)
+                    value = EGTB_DRAW;
+            }
+            if(value != EGTB_UNKNOWN)
+                file << e.mover << " " << e.other << " " << value << "\n";
+        }
+
+        file.close();
+        return true;
+    }
+};
+
+#endif // PROOF_NUMBER_CPP
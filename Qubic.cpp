@@ -0,0 +1,464 @@
+#ifndef QUBIC_CPP
+#define QUBIC_CPP
+
+#include <iostream>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include "Board.h"
+#include "Symmetry.h"
+#include "Transposition_table.cpp"
+using namespace std;
+
+// Size of the transposition table of the Qubic search (2^QUBIC_TT_SIZE_LOG2 slots of 16 bytes)
+#define QUBIC_TT_SIZE_LOG2 20
+#define QUBIC_LINES 76
+#define QUBIC_SYMMETRIES 48
+
+/**
+ * @brief Builds the 76 winning lines of the 4x4x4 cube (cell z*16 + x*4 + y):
+ * 48 along the axes, 24 diagonals of the planes and 4 diagonals of the cube.
+ */
+constexpr array<uint64_t, QUBIC_LINES> build_qubic_lines() {
+    array<uint64_t, QUBIC_LINES> lines{};
+    int l = 0;
+    for(int dz = -1; dz <= 1; dz++)
+        for(int dx = -1; dx <= 1; dx++)
+            for(int dy = -1; dy <= 1; dy++) {
+                // One of each pair of opposite directions: the first non-zero step is positive
+                int first = dz != 0 ? dz : dx != 0 ? dx : dy;
+                if(first <= 0)
+                    continue;
+                for(int z = 0; z < 4; z++)
+                    for(int x = 0; x < 4; x++)
+                        for(int y = 0; y < 4; y++) {
+                            int ez = z + 3 * dz, ex = x + 3 * dx, ey = y + 3 * dy;
+                            if(ez < 0 || ez > 3 || ex < 0 || ex > 3 || ey < 0 || ey > 3)
+                                continue;
+                            uint64_t mask = 0;
+                            for(int i = 0; i < 4; i++)
+                                mask |= 1ULL << ((z + i * dz) * 16 + (x + i * dx) * 4 + (y + i * dy));
+                            lines[l++] = mask;
+                        }
+            }
+    return lines;
+}
+
+/**
+ * @brief Builds the cell map of the 48 symmetries of the cube: the 6 orders of the
+ * axes combined with the 8 sets of mirrored axes (transform id = order * 8 + mirrors).
+ */
+constexpr array<array<uint8_t, 64>, QUBIC_SYMMETRIES> build_qubic_symmetries() {
+    const int orders[6][3] = {{0, 1, 2}, {0, 2, 1}, {1, 0, 2}, {1, 2, 0}, {2, 0, 1}, {2, 1, 0}};
+    array<array<uint8_t, 64>, QUBIC_SYMMETRIES> map{};
+    for(int p = 0; p < 6; p++)
+        for(int m = 0; m < 8; m++)
+            for(int cell = 0; cell < 64; cell++) {
+                int coord[3] = {cell / 16, cell / 4 % 4, cell % 4}, mapped[3] = {0, 0, 0};
+                for(int a = 0; a < 3; a++)
+                    mapped[a] = (m >> a & 1) ? 3 - coord[orders[p][a]] : coord[orders[p][a]];
+                map[p * 8 + m][cell] = (uint8_t)(mapped[0] * 16 + mapped[1] * 4 + mapped[2]);
+            }
+    return map;
+}
+
+/**
+ * @brief Lists, for every cell, the lines through it (4 or 7, the rest of the row is 0).
+ */
+constexpr array<array<uint64_t, 7>, 64> build_qubic_cell_lines() {
+    array<array<uint64_t, 7>, 64> cell_lines{};
+    array<int, 64> count{};
+    for(auto line : build_qubic_lines())
+        for(int cell = 0; cell < 64; cell++)
+            if(line >> cell & 1)
+                cell_lines[cell][count[cell]++] = line;
+    return cell_lines;
+}
+
+/**
+ * @class QUBIC_BOARD
+ * @brief 4x4x4 cube version of BOARD: one 64-bit bitboard per player, 4 in a row on any of the 76 lines.
+ * Cell z*16 + x*4 + y is layer z, row x and column y.
+ */
+class QUBIC_BOARD {
+    public:
+    static constexpr int CELLS = 64;
+    static constexpr array<uint64_t, QUBIC_LINES> line_masks = build_qubic_lines();
+    static constexpr array<array<uint64_t, 7>, 64> cell_lines = build_qubic_cell_lines();
+    static constexpr array<array<uint8_t, 64>, QUBIC_SYMMETRIES> cell_map = build_qubic_symmetries();
+
+    private:
+    uint64_t bits[2];       // Cells taken by 'X' [0] and by 'O' [1]
+    int used_cells;
+    char winner;
+    int win_cells;          // Value of used_cells when the line was completed
+
+    public:
+    QUBIC_BOARD() {
+        reset_board();
+    }
+
+    void reset_board(void) {
+        bits[0] = bits[1] = 0;
+        used_cells = 0;
+        winner = EMPTY_CELL;
+        win_cells = 0;
+    }
+
+    bool valid_move(short int z, short int x, short int y) const {
+        if(z < 0 || z > 3 || x < 0 || x > 3 || y < 0 || y > 3)
+            return false;
+        return !((bits[0] | bits[1]) >> (z * 16 + x * 4 + y) & 1);
+    }
+
+    /**
+     * @brief Places a symbol without validating it. Only the lines through the cell are checked.
+     */
+    void do_move(char player, int index) {
+        int side = player == 'O';
+        bits[side] |= 1ULL << index;
+        used_cells++;
+        if(winner == EMPTY_CELL)
+            for(auto line : cell_lines[index]) {
+                if(line == 0)
+                    break;
+                if((bits[side] & line) == line) {
+                    winner = player;
+                    win_cells = used_cells;
+                    break;
+                }
+            }
+    }
+
+    void undo_move(int index) {
+        if(winner != EMPTY_CELL && win_cells == used_cells)
+            winner = EMPTY_CELL;
+        bits[0] &= ~(1ULL << index);
+        bits[1] &= ~(1ULL << index);
+        used_cells--;
+    }
+
+    bool make_move(char player, short int z, short int x, short int y) {
+        if(!valid_move(z, x, y))
+            return false;
+        do_move(player, z * 16 + x * 4 + y);
+        return true;
+    }
+
+    bool check_win(short int z, short int x, short int y) const {
+        int index = z * 16 + x * 4 + y;
+        char symbol = (bits[0] >> index & 1) ? 'X' : (bits[1] >> index & 1) ? 'O' : EMPTY_CELL;
+        return symbol != EMPTY_CELL && winner == symbol;
+    }
+
+    char get_cell(int index) const {
+        return (bits[0] >> index & 1) ? 'X' : (bits[1] >> index & 1) ? 'O' : EMPTY_CELL;
+    }
+
+    char get_winner(void) const {
+        return winner;
+    }
+
+    bool full(void) const {
+        return used_cells == CELLS;
+    }
+
+    uint64_t get_bits(int side) const {
+        return bits[side];
+    }
+
+    int get_used_cells(void) const {
+        return used_cells;
+    }
+
+    /**
+     * @brief Gets the grid (one symbol per cell), in the same form as BOARD::grid.
+     */
+    vector<char> get_grid(void) const {
+        vector<char> grid(CELLS);
+        for(int i = 0; i < CELLS; i++)
+            grid[i] = get_cell(i);
+        return grid;
+    }
+
+    /**
+     * @brief Gets the smallest image of the position under the 48 symmetries, as bitboards.
+     * @param transform optional output with the id of the transform used
+     */
+    pair<uint64_t, uint64_t> get_canonical(int *transform = NULL) const {
+        pair<uint64_t, uint64_t> best = {bits[0], bits[1]};
+        if(transform != NULL)
+            *transform = 0;
+        for(int t = 1; t < QUBIC_SYMMETRIES; t++) {
+            pair<uint64_t, uint64_t> image = {0, 0};
+            for(int s = 0; s < 2; s++)
+                for(uint64_t rest = bits[s]; rest; rest &= rest - 1)
+                    (s ? image.second : image.first) |= 1ULL << cell_map[t][__builtin_ctzll(rest)];
+            if(image < best) {
+                best = image;
+                if(transform != NULL)
+                    *transform = t;
+            }
+        }
+        return best;
+    }
+
+    /**
+     * @brief Same as get_canonical, on a grid compared lexicographically like SYMMETRY_T::get_canonical.
+     */
+    static vector<char> get_canonical_grid(const vector<char>& grid) {
+        vector<char> best = grid, image(CELLS);
+        for(int t = 1; t < QUBIC_SYMMETRIES; t++) {
+            for(int i = 0; i < CELLS; i++)
+                image[cell_map[t][i]] = grid[i];
+            if(image < best)
+                best = image;
+        }
+        return best;
+    }
+
+    /**
+     * @brief Prints the four layers side by side.
+     */
+    void draw_board(void) const {
+        for(int z = 0; z < 4; z++)
+            cout << "  layer " << z + 1 << "          ";
+        cout << endl;
+        for(int x = 0; x < 4; x++) {
+            for(int z = 0; z < 4; z++) {
+                cout << "| ";
+                for(int y = 0; y < 4; y++)
+                    cout << get_cell(z * 16 + x * 4 + y) << " | ";
+                cout << "  ";
+            }
+            cout << endl;
+        }
+    }
+};
+
+/**
+ * @class QUBIC_SEARCH
+ * @brief Iterative-deepening alpha-beta player for the cube with a time budget.
+ * It uses a transposition table, the cells on more lines first and the same line
+ * heuristic as the parallel search of Optimal_algorithm_T at the depth limit.
+ */
+class QUBIC_SEARCH {
+    static constexpr int MATE = 1 << 20;
+
+    private:
+    TRANSPOSITION_TABLE table;
+    long long nodes;
+    chrono::steady_clock::time_point start;
+    bool stopped;
+    // Cells ordered by the number of lines through them
+    uint8_t cell_order[64];
+
+    static uint64_t position_key(const QUBIC_BOARD &board) {
+        uint64_t x = board.get_bits(0) * 0x9E3779B97F4A7C15ULL ^ board.get_bits(1) * 0xC2B2AE3D27D4EB4FULL;
+        x ^= x >> 30; x *= 0xBF58476D1CE4E5B9ULL;
+        x ^= x >> 27; x *= 0x94D049BB133111EBULL;
+        x ^= x >> 31;
+        return x ? x : 1;
+    }
+
+    static int heuristic(const QUBIC_BOARD &board, int me) {
+        uint64_t mine = board.get_bits(me), theirs = board.get_bits(!me);
+        int score = 0;
+        for(auto line : QUBIC_BOARD::line_masks) {
+            int a = __builtin_popcountll(mine & line), b = __builtin_popcountll(theirs & line);
+            if(b == 0 && a > 0)
+                score += 1 << (3 * (a - 1));
+            else if(a == 0 && b > 0)
+                score -= 1 << (3 * (b - 1));
+        }
+        return score;
+    }
+
+    int negamax(QUBIC_BOARD &board, int depth, int ply, int alpha, int beta, int me) {
+        nodes++;
+        if((nodes & 1023) == 0 && time_budget_ms > 0 &&
+            chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() >= time_budget_ms)
+            stopped = true;
+        if(stopped)
+            return 0;
+        if(board.get_winner() != EMPTY_CELL)
+            return -(MATE - ply);
+        if(board.full())
+            return 0;
+        if(depth == 0)
+            return heuristic(board, me);
+
+        uint64_t key = position_key(board);
+        int alpha_orig = alpha;
+        short tt_cell = -1;
+        TRANSPOSITION_TABLE::ENTRY entry;
+        if(table.probe(key, entry)) {
+            tt_cell = entry.cell;
+            if(entry.depth >= depth) {
+                int score = entry.score > MATE - 256 ? entry.score - ply : entry.score < 256 - MATE ? entry.score + ply : entry.score;
+                if(entry.bound == TT_EXACT || (entry.bound == TT_LOWER && score >= beta) || (entry.bound == TT_UPPER && score <= alpha))
+                    return score;
+            }
+        }
+
+        uint64_t taken = board.get_bits(0) | board.get_bits(1);
+        int best = -MATE - 1;
+        short best_cell = -1;
+        for(int m = -1; m < 64; m++) {
+            int cell = m < 0 ? tt_cell : cell_order[m];
+            if(cell < 0 || cell >= 64 || (taken >> cell & 1) || (m >= 0 && cell == tt_cell))
+                continue;
+            board.do_move(me ? 'O' : 'X', cell);
+            int score = -negamax(board, depth - 1, ply + 1, -beta, -alpha, !me);
+            board.undo_move(cell);
+            if(stopped)
+                return 0;
+            if(score > best) {
+                best = score;
+                best_cell = (short)cell;
+            }
+            alpha = max(alpha, best);
+            if(alpha >= beta)
+                break;
+        }
+
+        short bound = best <= alpha_orig ? TT_UPPER : best >= beta ? TT_LOWER : TT_EXACT;
+        int stored = best > MATE - 256 ? best + ply : best < 256 - MATE ? best - ply : best;
+        table.store(key, stored, best_cell, depth, bound);
+        return best;
+    }
+
+    public:
+    struct Move {
+        int layer, row, col;
+    };
+
+    struct SearchStats {
+        long long nodes;
+        double time_ms;
+        int depth;          // Last depth the search completed
+    };
+
+    int max_depth;
+    double time_budget_ms;
+
+    QUBIC_SEARCH(int max_depth = 64, double time_budget_ms = 500)
+        : table(QUBIC_TT_SIZE_LOG2), nodes(0), stopped(false), max_depth(max_depth), time_budget_ms(time_budget_ms) {
+        for(int i = 0; i < 64; i++)
+            cell_order[i] = (uint8_t)i;
+        // Cells on 7 lines (corners and the centre of the cube) come first
+        stable_sort(cell_order, cell_order + 64, [](uint8_t a, uint8_t b) {
+            return QUBIC_BOARD::cell_lines[a][4] != 0 && QUBIC_BOARD::cell_lines[b][4] == 0;
+        });
+    }
+
+    /**
+     * @brief Returns the best move for 'player' found within the budget.
+     */
+    Move findBestMove(QUBIC_BOARD &board, char player, SearchStats *stats = NULL) {
+        start = chrono::steady_clock::now();
+        nodes = 0;
+        stopped = false;
+        int me = player == 'O';
+        uint64_t taken = board.get_bits(0) | board.get_bits(1);
+        int best_cell = -1, completed = 0;
+        for(int m = 0; m < 64 && best_cell < 0; m++)
+            if(!(taken >> cell_order[m] & 1))
+                best_cell = cell_order[m];
+        if(best_cell < 0 || board.get_winner() != EMPTY_CELL)
+            return {-1, -1, -1};
+
+        for(int depth = 1; depth <= max_depth && depth <= 64 - board.get_used_cells(); depth++) {
+            int alpha = -MATE - 1, best = -MATE - 1, cell = best_cell;
+            for(int m = -1; m < 64; m++) {
+                int c = m < 0 ? best_cell : cell_order[m];
+                if((taken >> c & 1) || (m >= 0 && c == best_cell))
+                    continue;
+                board.do_move(player, c);
+                int score = -negamax(board, depth - 1, 1, -MATE - 1, -alpha, !me);
+                board.undo_move(c);
+                if(stopped)
+                    break;
+                if(score > best) {
+                    best = score;
+                    cell = c;
+                }
+                alpha = max(alpha, best);
+            }
+            if(stopped)
+                break;
+            best_cell = cell;
+            completed = depth;
+            if(best > MATE - 256 || best < 256 - MATE)
+                break;
+        }
+
+        if(stats != NULL) {
+            stats->nodes = nodes;
+            stats->depth = completed;
+            stats->time_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        }
+        return {best_cell / 16, best_cell / 4 % 4, best_cell % 4};
+    }
+};
+
+/**
+ * @class TicTacToeQubic
+ * @brief Plays a game on the cube between two players, each one a search or the user.
+ */
+class TicTacToeQubic {
+    private:
+    QUBIC_BOARD board;
+    QUBIC_SEARCH* players[2]; // 'X' [0] and 'O' [1], NULL for the user
+
+    public:
+    TicTacToeQubic(QUBIC_SEARCH* x, QUBIC_SEARCH* o) : board(), players{x, o} {}
+
+    /**
+     * @brief Runs a game, 'X' moves first.
+     * @return the result for 'X' (WIN, LOSS or DRAW)
+     */
+    short run_game(const bool& print = true) {
+        board.reset_board();
+        char symbol = 'X';
+        while(board.get_winner() == EMPTY_CELL && !board.full()) {
+            if(print)
+                board.draw_board();
+            QUBIC_SEARCH* player = players[symbol == 'O'];
+            int z = -1, x = -1, y = -1;
+            if(player != NULL) {
+                QUBIC_SEARCH::SearchStats stats;
+                QUBIC_SEARCH::Move move = player->findBestMove(board, symbol, &stats);
+                z = move.layer;
+                x = move.row;
+                y = move.col;
+                if(print)
+                    cout << "Player " << symbol << " (Search) plays: " << z + 1 << ", " << x + 1 << ", " << y + 1
+                         << " (depth " << stats.depth << ", " << stats.nodes << " nodes)" << endl;
+            }
+            else {
+                while(!board.valid_move(z, x, y)) {
+                    cout << "Choose a valid layer (1-4), row (1-4) and collumn (1-4)";
+                    if(!(cin >> z >> x >> y))
+                        return DRAW;
+                    z--; x--; y--;
+                }
+            }
+            board.make_move(symbol, z, x, y);
+            symbol = symbol == 'X' ? 'O' : 'X';
+        }
+
+        if(print) {
+            board.draw_board();
+            if(board.get_winner() == EMPTY_CELL)
+                cout << "It's a draw!\n";
+            else
+                cout << "Player " << board.get_winner() << " won!\n";
+        }
+        return board.get_winner() == 'X' ? WIN : board.get_winner() == 'O' ? LOSS : DRAW;
+    }
+};
+
+#endif // QUBIC_CPP
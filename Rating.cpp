@@ -0,0 +1,174 @@
+#ifndef RATING_CPP
+#define RATING_CPP
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include "Board.h"
+using namespace std;
+
+// Skill of a new individual and its uncertainty (standard deviation), in Elo-like points
+#define RATING_MU 1500.0
+#define RATING_SIGMA 500.0
+// Spread of one game's performance around the skill
+#define RATING_BETA 250.0
+// Uncertainty added before every game, so the ratings can follow bots that change
+#define RATING_TAU 5.0
+// Share of the games between two equal individuals that end in a draw
+#define RATING_DRAW_PROBABILITY 0.6
+// Chance that the leader is better than each other individual at which the ranking is trusted
+#define RATING_CONFIDENCE 0.9
+
+/**
+ * @brief Skill estimate of an individual: the skill is believed to be normal with mean
+ * 'mu' and standard deviation 'sigma'.
+ */
+struct RATING {
+    double mu, sigma;
+
+    RATING(double mu = RATING_MU, double sigma = RATING_SIGMA) : mu(mu), sigma(sigma) {}
+
+    /**
+     * @brief Skill the individual has with high confidence (mu - 3 sigma), used to rank it.
+     */
+    int conservative(void) const {
+        return (int)round(mu - 3 * sigma);
+    }
+};
+
+/**
+ * @class RATING_SYSTEM
+ * @brief Updates RATINGs after every game with the two-player TrueSkill rules.
+ *
+ * A game is won by the individual whose performance (its skill plus normal noise of
+ * deviation 'beta') is higher by more than a draw margin, otherwise it is a draw. Each
+ * result moves the means by how surprising it was and shrinks both deviations, so an
+ * individual is known after a few games against well-known opponents instead of a fixed
+ * number of rounds, and a draw between two bots is evidence too. The margin is chosen
+ * so that RATING_DRAW_PROBABILITY of the games between equal individuals are draws.
+ */
+class RATING_SYSTEM {
+    private:
+    // Draw margin on the performance difference
+    double margin;
+
+    static double pdf(double x) {
+        return exp(-x * x / 2) / sqrt(2 * M_PI);
+    }
+
+    static double cdf(double x) {
+        return erfc(-x / sqrt(2.0)) / 2;
+    }
+
+    static double inverse_cdf(double p) {
+        double low = -10, high = 10;
+        for(int i = 0; i < 100; i++) {
+            double middle = (low + high) / 2;
+            (cdf(middle) < p ? low : high) = middle;
+        }
+        return (low + high) / 2;
+    }
+
+    /**
+     * @brief Mean and variance corrections of a win by a normalised difference 't' (margin 'e').
+     */
+    static void win_factors(double t, double e, double& v, double& w) {
+        double x = t - e;
+        double d = cdf(x);
+        v = d > 1e-300 ? pdf(x) / d : -x;
+        w = v * (v + x);
+    }
+
+    /**
+     * @brief Mean and variance corrections of a draw by a normalised difference 't' (margin 'e').
+     */
+    static void draw_factors(double t, double e, double& v, double& w) {
+        double a = e - fabs(t), b = -e - fabs(t);
+        double d = cdf(a) - cdf(b);
+        v = d > 1e-300 ? (pdf(b) - pdf(a)) / d : a;
+        w = d > 1e-300 ? v * v + (a * pdf(a) - b * pdf(b)) / d : 1;
+        if(t < 0)
+            v = -v;
+    }
+
+    public:
+    double beta, tau;
+
+    RATING_SYSTEM(double beta = RATING_BETA, double tau = RATING_TAU, double draw_probability = RATING_DRAW_PROBABILITY)
+        : margin(sqrt(2.0) * beta * inverse_cdf((draw_probability + 1) / 2)), beta(beta), tau(tau) {}
+
+    double get_margin(void) const {
+        return margin;
+    }
+
+    /**
+     * @brief Updates both ratings with the result of one game.
+     * @param result WIN, DRAW or LOSS, for 'first'
+     */
+    void update(RATING& first, RATING& second, short result) const {
+        RATING& winner = result == LOSS ? second : first;
+        RATING& loser = result == LOSS ? first : second;
+        winner.sigma = sqrt(winner.sigma * winner.sigma + tau * tau);
+        loser.sigma = sqrt(loser.sigma * loser.sigma + tau * tau);
+
+        double c = sqrt(2 * beta * beta + winner.sigma * winner.sigma + loser.sigma * loser.sigma);
+        double t = (winner.mu - loser.mu) / c, e = margin / c;
+        double v, w;
+        if(result == DRAW)
+            draw_factors(t, e, v, w);
+        else
+            win_factors(t, e, v, w);
+        // Rounding can push w out of (0, 1), where the variances would not shrink or turn negative
+        w = min(max(w, 0.0), 1 - 1e-9);
+
+        double winner_variance = winner.sigma * winner.sigma, loser_variance = loser.sigma * loser.sigma;
+        winner.mu += winner_variance / c * v;
+        loser.mu -= loser_variance / c * v;
+        winner.sigma = sqrt(winner_variance * (1 - winner_variance / (c * c) * w));
+        loser.sigma = sqrt(loser_variance * (1 - loser_variance / (c * c) * w));
+    }
+
+    /**
+     * @brief How likely a game between the two is to be close (1 for two equal, well-known individuals).
+     */
+    double quality(const RATING& a, const RATING& b) const {
+        double spread = 2 * beta * beta + a.sigma * a.sigma + b.sigma * b.sigma;
+        double difference = a.mu - b.mu;
+        return sqrt(2 * beta * beta / spread) * exp(-difference * difference / (2 * spread));
+    }
+
+    /**
+     * @brief Chance that 'a' has a higher skill than 'b'.
+     */
+    static double better(const RATING& a, const RATING& b) {
+        return cdf((a.mu - b.mu) / sqrt(a.sigma * a.sigma + b.sigma * b.sigma));
+    }
+
+    /**
+     * @brief Whether the individual with the highest mean is better than every other one
+     * with chance RATING_CONFIDENCE (the leader is the one selection depends on).
+     */
+    static bool confident(const vector<RATING>& ratings) {
+        if(ratings.size() < 2)
+            return true;
+        int leader = 0;
+        for(int i = 1; i < (int)ratings.size(); i++)
+            if(ratings[i].mu > ratings[leader].mu)
+                leader = i;
+        for(int i = 0; i < (int)ratings.size(); i++)
+            if(i != leader && better(ratings[leader], ratings[i]) < RATING_CONFIDENCE)
+                return false;
+        return true;
+    }
+
+    /**
+     * @brief Rating of a child of two parents: their average skill, with the uncertainty a
+     * mutated genome brings (never above a new individual's).
+     */
+    static RATING child(const RATING& a, const RATING& b) {
+        double variance = (a.sigma * a.sigma + b.sigma * b.sigma) / 2 + RATING_SIGMA * RATING_SIGMA / 4;
+        return RATING((a.mu + b.mu) / 2, min(sqrt(variance), RATING_SIGMA));
+    }
+};
+
+#endif // RATING_CPP
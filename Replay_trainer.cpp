@@ -0,0 +1,168 @@
+#ifndef REPLAY_TRAINER_CPP
+#define REPLAY_TRAINER_CPP
+
+#include <vector>
+#include <map>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <iostream>
+#include "Board.h"
+#include "Symmetry.h"
+#include "Bot.cpp"
+#include "Game_log.cpp"
+using namespace std;
+
+// Games replayed between two updates of the genomes
+#define REPLAY_BATCH 100000
+// Largest sum of a state's scores: bigger states are scaled down, far from overflowing choose_move's sum
+#define REPLAY_MAX_TOTAL 1000000000LL
+
+/**
+ * @class REPLAY_TRAINER_T
+ * @brief Trains a BOT_T offline from a game log, without playing any game.
+ *
+ * Every move of the learned side is replayed as the (canonical state, move, result)
+ * the bot would have seen online, and rewarded with the bot's win/draw/loss rewards,
+ * so the same log can train bots with different reward settings. The log is read in
+ * batches of REPLAY_BATCH games: the threads split a batch, each one summing the
+ * rewards of every (state, move) of its games, and the sums are merged and applied to
+ * the genomes at the end of the batch. Inside a batch every reward is a share of the
+ * state's total at the start of the batch, where the online update sees the total
+ * grow after each game. A state whose total passes REPLAY_MAX_TOTAL is scaled down,
+ * which keeps the chances of its moves.
+ */
+template<int ROWS, int COLS, int K>
+class REPLAY_TRAINER_T {
+    typedef BOT_T<ROWS, COLS, K> BOT;
+    typedef SYMMETRY_T<ROWS> SYMMETRY;
+    static constexpr int CELLS = ROWS * COLS;
+    // Summed rewards of each move of a canonical state
+    typedef map<vector<char>, vector<double>> REWARDS;
+
+    private:
+    BOT* bot;
+
+    /**
+     * @brief Sums the rewards of the learned moves of games[begin, end).
+     */
+    void replay(const vector<GAME_RECORD>& games, size_t begin, size_t end, REWARDS& rewards, long long& moves) const {
+        vector<char> grid(CELLS);
+        for(size_t g = begin; g < end; g++) {
+            const GAME_RECORD& game = games[g];
+            char second_symbol = game.first_symbol == 'X' ? 'O' : 'X';
+            float first_reward = bot->reward_of(game.result == LOG_DRAW ? DRAW : game.result == LOG_FIRST_WINS ? WIN : LOSS);
+            float second_reward = bot->reward_of(game.result == LOG_DRAW ? DRAW : game.result == LOG_SECOND_WINS ? WIN : LOSS);
+
+            fill(grid.begin(), grid.end(), EMPTY_CELL);
+            for(int i = 0; i < game.count; i++) {
+                char player = i % 2 == 0 ? game.first_symbol : second_symbol;
+                short cell = game.moves[i];
+                if(side == EMPTY_CELL || side == player) {
+                    auto canon = SYMMETRY::get_canonical(grid, {cell / COLS, cell % COLS}, NULL, NULL);
+                    vector<double>& sums = rewards[canon.first];
+                    if(sums.empty())
+                        sums.assign(CELLS, 0);
+                    sums[canon.second.first * COLS + canon.second.second] += i % 2 == 0 ? first_reward : second_reward;
+                    moves++;
+                }
+                grid[cell] = player;
+            }
+        }
+    }
+
+    /**
+     * @brief Replays one batch on every thread and applies the merged rewards.
+     */
+    void train_batch(const vector<GAME_RECORD>& games) {
+        int workers = (int)min<size_t>(threads, max<size_t>(1, games.size()));
+        vector<REWARDS> rewards(workers);
+        vector<long long> moves(workers, 0);
+        vector<thread> pool;
+        for(int t = 0; t < workers; t++) {
+            size_t begin = games.size() * t / workers, end = games.size() * (t + 1) / workers;
+            pool.emplace_back(&REPLAY_TRAINER_T::replay, this, cref(games), begin, end, ref(rewards[t]), ref(moves[t]));
+        }
+        for(auto& t : pool)
+            t.join();
+
+        // Merges into the first thread's sums
+        for(int t = 1; t < workers; t++)
+            for(auto& entry : rewards[t]) {
+                vector<double>& sums = rewards[0][entry.first];
+                if(sums.empty())
+                    sums.assign(CELLS, 0);
+                for(int i = 0; i < CELLS; i++)
+                    sums[i] += entry.second[i];
+            }
+
+        for(auto& entry : rewards[0]) {
+            if(bot->genomes.count(entry.first) == 0)
+                bot->new_board_state(entry.first);
+            typename BOT::GENOME& genome = bot->genome_of(entry.first);
+            long long total = 0;
+            for(auto& g : genome)
+                total += g;
+            vector<double> updated(genome.begin(), genome.end());
+            double new_total = 0;
+            for(int i = 0; i < CELLS; i++) {
+                // Only the valid moves that were played change
+                if(genome[i] != 0 && entry.second[i] != 0)
+                    updated[i] = max(1.0, updated[i] + total * entry.second[i]);
+                new_total += updated[i];
+            }
+
+            double scale = new_total > REPLAY_MAX_TOTAL ? REPLAY_MAX_TOTAL / new_total : 1;
+            for(int i = 0; i < CELLS; i++)
+                if(genome[i] != 0)
+                    genome[i] = max(1LL, (long long)(updated[i] * scale));
+        }
+
+        games_replayed += games.size();
+        for(auto m : moves)
+            moves_replayed += m;
+    }
+
+    public:
+    // Symbol whose moves are learned, EMPTY_CELL learns the moves of both players
+    char side;
+    // Threads that split each batch
+    unsigned threads;
+    // Totals of the replays so far
+    long long games_replayed, moves_replayed;
+    double time_ms;
+
+    REPLAY_TRAINER_T(BOT& bot, char side = 'X')
+        : bot(&bot), side(side), threads(max(1u, thread::hardware_concurrency())), games_replayed(0), moves_replayed(0), time_ms(0) {}
+
+    /**
+     * @brief Replays every game of a log into the bot's genomes.
+     * @param filename a log written by GAME_LOG_WRITER_T for this board
+     * @return false if the log could not be opened
+     */
+    bool train(const string& filename) {
+        GAME_LOG_READER_T<ROWS, COLS, K> reader;
+        if(!reader.open(filename))
+            return false;
+
+        auto start = chrono::steady_clock::now();
+        vector<GAME_RECORD> batch;
+        batch.reserve(REPLAY_BATCH);
+        GAME_RECORD game;
+        while(reader.next(game)) {
+            batch.push_back(game);
+            if(batch.size() == REPLAY_BATCH) {
+                train_batch(batch);
+                batch.clear();
+            }
+        }
+        if(!batch.empty())
+            train_batch(batch);
+        time_ms += chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        return true;
+    }
+};
+
+typedef REPLAY_TRAINER_T<3, 3, 3> REPLAY_TRAINER;
+
+#endif // REPLAY_TRAINER_CPP
@@ -0,0 +1,324 @@
+#ifndef STEADY_STATE_CPP
+#define STEADY_STATE_CPP
+
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <iostream>
+#include "Board.h"
+#include "Bot.cpp"
+#include "Game_log.cpp"
+#include "Play.cpp"
+#include "Philox.cpp"
+using namespace std;
+
+// Individuals of a steady-state population (a worker needs one to play and three to breed)
+#define STEADY_INDIVIDUALS 32
+// Evaluations (one game as 'X' and one as 'O') between two replacements tried by a worker
+#define STEADY_REPLACE_EVERY 4
+// Individuals sampled by each tournament that picks a parent
+#define STEADY_TOURNAMENT 3
+// Games an individual plays before it can be chosen as a parent or replaced
+#define STEADY_MIN_GAMES 4
+
+/**
+ * @class STEADY_STATE_T
+ * @brief Evolves a population against a search teacher with no generations: every
+ * worker thread keeps picking an idle individual, plays it as 'X' and as 'O', and
+ * every STEADY_REPLACE_EVERY evaluations replaces the worst individual with a child
+ * of two tournament-selected parents.
+ *
+ * Each individual has a busy flag that a worker takes with a compare-and-swap and only
+ * ever tries: a worker that fails to take the individuals it wants picks others or
+ * skips the replacement, so no worker waits for another and there is no barrier
+ * between generations. The scores are atomics read without taking the flags.
+ * Fitness is the mean result (1 win, 0 draw, -1 loss) of the individual's games.
+ * Each worker has its own teacher (a copy of the one given to run()) and its own
+ * random generator; the 3x3 minimax cache and the transposition table are already
+ * shared safely between threads. Every bot draws its moves from the PHILOX stream of
+ * (replacement it was born at, index), so with one worker a run is reproducible from
+ * its seed; with more, the order of the games depends on the scheduling.
+ */
+template<int ROWS, int COLS, int K, class TEACHER = Optimal_algorithm_T<ROWS, COLS, K>>
+class STEADY_STATE_T {
+    typedef BOT_T<ROWS, COLS, K> BOT;
+    typedef TicTacToeMiniMax_T<ROWS, COLS, K, TEACHER> GAME;
+    typedef GAME_LOG_WRITER_T<ROWS, COLS, K> GAME_LOG_WRITER;
+
+    public:
+    struct INDIVIDUAL {
+        BOT bot;
+        atomic<bool> busy;
+        atomic<long long> score;    // Wins minus losses
+        atomic<long long> games;
+        long long born;             // Replacements done before this individual was made
+
+        INDIVIDUAL() : bot('X'), busy(false), score(0), games(0), born(0) {}
+
+        double fitness(void) const {
+            long long played = games.load(memory_order_relaxed);
+            return played == 0 ? 0 : (double)score.load(memory_order_relaxed) / played;
+        }
+    };
+
+    private:
+    vector<INDIVIDUAL> pop;
+    atomic<long long> games_started;
+    atomic<long long> replacements, failed_claims;
+    long long games_total;
+    uint64_t seed;
+    // Calls of run() so far, the generation coordinate of the workers' streams
+    uint32_t runs;
+
+    bool claim(int i) {
+        bool expected = false;
+        return pop[i].busy.compare_exchange_strong(expected, true, memory_order_acquire);
+    }
+
+    void release(int i) {
+        pop[i].busy.store(false, memory_order_release);
+    }
+
+    /**
+     * @brief Takes a random idle individual, trying others until one is free.
+     */
+    int claim_any(PHILOX& rng) {
+        uniform_int_distribution<int> pick(0, pop.size() - 1);
+        for(int tries = 1; ; tries++) {
+            int i = pick(rng);
+            if(claim(i))
+                return i;
+            failed_claims.fetch_add(1, memory_order_relaxed);
+            if(tries % (int)pop.size() == 0)
+                this_thread::yield();
+        }
+    }
+
+    /**
+     * @brief Best of STEADY_TOURNAMENT random individuals that have played enough games.
+     * @return -1 if no sampled individual qualifies
+     */
+    int tournament(PHILOX& rng) const {
+        uniform_int_distribution<int> pick(0, pop.size() - 1);
+        int best = -1;
+        for(int t = 0; t < STEADY_TOURNAMENT; t++) {
+            int i = pick(rng);
+            if(pop[i].games.load(memory_order_relaxed) < STEADY_MIN_GAMES)
+                continue;
+            if(best == -1 || pop[i].fitness() > pop[best].fitness())
+                best = i;
+        }
+        return best;
+    }
+
+    /**
+     * @brief The individual with the lowest fitness among those that have played enough games.
+     */
+    int worst(void) const {
+        int found = -1;
+        for(int i = 0; i < (int)pop.size(); i++) {
+            if(pop[i].games.load(memory_order_relaxed) < STEADY_MIN_GAMES)
+                continue;
+            if(found == -1 || pop[i].fitness() < pop[found].fitness())
+                found = i;
+        }
+        return found;
+    }
+
+    /**
+     * @brief Writes the average of two parents into 'child', then mutates it.
+     * States only one parent knows are copied from it; occupied cells stay at 0.
+     */
+    void breed(const BOT& a, const BOT& b, BOT& child, PHILOX& rng) const {
+        child = a;
+        for(auto& [state, genome] : b.genomes) {
+            auto found = child.genomes.find(state);
+            if(found == child.genomes.end()) {
+                child.genomes[state].assign(genome.begin(), genome.end());
+                continue;
+            }
+            for(size_t j = 0; j < genome.size(); j++)
+                found->second[j] = (found->second[j] + genome[j]) / 2;
+        }
+
+        uniform_real_distribution<double> chance(0.0, 1.0);
+        normal_distribution<double> noise(0.0, mutation_step);
+        for(auto& [state, genome] : child.genomes)
+            for(auto& g : genome)
+                if(g != 0 && chance(rng) <= mutation_rate)
+                    g = max(1LL, g + (long long)round(noise(rng)));
+    }
+
+    /**
+     * @brief Replaces the worst individual with a child of two tournament winners.
+     * @return false if the individuals were not all idle (nothing changes then)
+     */
+    bool replace_worst(PHILOX& rng) {
+        int loser = worst();
+        int a = tournament(rng), b = tournament(rng);
+        if(loser == -1 || a == -1 || b == -1 || loser == a || loser == b)
+            return false;
+
+        if(!claim(loser))
+            return false;
+        if(!claim(a)) {
+            release(loser);
+            return false;
+        }
+        if(b != a && !claim(b)) {
+            release(a);
+            release(loser);
+            return false;
+        }
+
+        INDIVIDUAL& child = pop[loser];
+        child.born = replacements.fetch_add(1, memory_order_relaxed) + 1;
+        PHILOX mutation(seed, child.born, loser, PHILOX_MUTATION);
+        breed(pop[a].bot, pop[b].bot, child.bot, mutation);
+        child.bot.rng.seek(child.born, loser);
+        child.score.store(0, memory_order_relaxed);
+        child.games.store(0, memory_order_relaxed);
+
+        if(b != a)
+            release(b);
+        release(a);
+        release(loser);
+        return true;
+    }
+
+    void work(int id, TEACHER teacher, GAME_LOG_WRITER* game_log, double* busy_ms) {
+        PHILOX rng(seed, runs, PHILOX_POPULATION, id);
+        auto busy = chrono::duration<double, milli>::zero();
+
+        for(long long evaluations = 1; games_started.fetch_add(2, memory_order_relaxed) < games_total; evaluations++) {
+            int i = claim_any(rng);
+            auto start = chrono::steady_clock::now();
+
+            GAME game(pop[i].bot, teacher);
+            game.game_log = game_log;
+            game.early_end = early_end;
+            long long score = 0;
+            for(bool bot_is_x : {true, false}) {
+                short result = game.run_game(bot_is_x, false);
+                score += result == WIN ? 1 : result == LOSS ? -1 : 0;
+            }
+            pop[i].score.fetch_add(score, memory_order_relaxed);
+            pop[i].games.fetch_add(2, memory_order_relaxed);
+            release(i);
+
+            if(evaluations % STEADY_REPLACE_EVERY == 0)
+                replace_worst(rng);
+            busy += chrono::steady_clock::now() - start;
+        }
+        *busy_ms = busy.count();
+    }
+
+    public:
+    // Chance of mutating each valid move's score, and the standard deviation of the noise
+    double mutation_rate, mutation_step;
+    // When the games end early (EARLY_OFF, EARLY_DRAWS or EARLY_FORCED)
+    int early_end;
+    // Worker threads (0 uses every core)
+    int threads;
+    // Results of the last run(): wall time and the share of it the workers spent playing or breeding
+    double time_ms, utilisation;
+
+    STEADY_STATE_T(int individuals = STEADY_INDIVIDUALS, uint64_t seed = 0)
+        : pop(max(individuals, 3)), games_started(0), replacements(0), failed_claims(0), games_total(0), seed(seed), runs(0),
+          mutation_rate(0.05), mutation_step(0.5), early_end(EARLY_OFF), threads(0), time_ms(0), utilisation(0) {
+        for(int i = 0; i < (int)pop.size(); i++) {
+            pop[i].bot.rng.set_seed(seed);
+            pop[i].bot.rng.seek(0, i);
+        }
+    }
+
+    INDIVIDUAL& operator[](int i) {
+        return pop[i];
+    }
+
+    int size(void) const {
+        return pop.size();
+    }
+
+    long long get_replacements(void) const {
+        return replacements;
+    }
+
+    long long get_failed_claims(void) const {
+        return failed_claims;
+    }
+
+    /**
+     * @brief The individual with the highest fitness among those that have played enough games.
+     */
+    int best(void) const {
+        int found = 0;
+        for(int i = 1; i < (int)pop.size(); i++)
+            if(pop[found].games < STEADY_MIN_GAMES || (pop[i].games >= STEADY_MIN_GAMES && pop[i].fitness() > pop[found].fitness()))
+                found = i;
+        return found;
+    }
+
+    /**
+     * @brief Indices of the individuals, from the highest fitness to the lowest.
+     */
+    vector<int> ranked(void) const {
+        vector<int> order(pop.size());
+        for(int i = 0; i < (int)pop.size(); i++)
+            order[i] = i;
+        stable_sort(order.begin(), order.end(), [this](int a, int b) { return pop[a].fitness() > pop[b].fitness(); });
+        return order;
+    }
+
+    /**
+     * @brief Forgets the games of an individual whose bot was replaced from outside, as a newborn child.
+     */
+    void reset_scores(int i) {
+        pop[i].score = 0;
+        pop[i].games = 0;
+        pop[i].born = replacements;
+        pop[i].bot.rng.set_seed(seed);
+        pop[i].bot.rng.seek(pop[i].born, i);
+    }
+
+    /**
+     * @brief Plays 'games' games over the worker threads, evolving the population as they finish.
+     * @param teacher the teacher every worker copies
+     * @param game_log_file log appended by every worker ("" logs nothing)
+     */
+    void run(long long games, const TEACHER& teacher, const string& game_log_file = "") {
+        int workers = threads > 0 ? threads : max(1u, thread::hardware_concurrency());
+        games_total = games;
+        games_started = 0;
+
+        // One writer per worker, all on the same log
+        unique_ptr<GAME_LOG_WRITER[]> logs;
+        if(!game_log_file.empty()) {
+            logs.reset(new GAME_LOG_WRITER[workers]);
+            for(int w = 0; w < workers; w++)
+                logs[w].open(game_log_file);
+        }
+
+        auto start = chrono::steady_clock::now();
+        vector<double> busy_ms(workers, 0);
+        vector<thread> pool;
+        for(int w = 1; w < workers; w++)
+            pool.emplace_back(&STEADY_STATE_T::work, this, w, teacher, logs ? &logs[w] : NULL, &busy_ms[w]);
+        work(0, teacher, logs ? &logs[0] : NULL, &busy_ms[0]);
+        for(auto& t : pool)
+            t.join();
+        time_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+        double busy_total = 0;
+        for(double b : busy_ms)
+            busy_total += b;
+        utilisation = busy_total / max(time_ms * workers, 1e-3);
+        runs++;
+    }
+};
+
+#endif // STEADY_STATE_CPP
@@ -0,0 +1,256 @@
+#include "Symmetry.h"
+
+using namespace std;
+
+// The classic board keeps its table written out, and the compile-time builder must match it
+constexpr array<array<short, 9>, 8> CLASSIC_CELL_MAP = {{
+    {0, 1, 2, 3, 4, 5, 6, 7, 8}, // identity
+    {2, 5, 8, 1, 4, 7, 0, 3, 6}, // 90º
+    {8, 7, 6, 5, 4, 3, 2, 1, 0}, // 180º
+    {6, 3, 0, 7, 4, 1, 8, 5, 2}, // 270º
+    {2, 1, 0, 5, 4, 3, 8, 7, 6}, // flip
+    {8, 5, 2, 7, 4, 1, 6, 3, 0}, // flip + 90º
+    {6, 7, 8, 3, 4, 5, 0, 1, 2}, // flip + 180º
+    {0, 3, 6, 1, 4, 7, 2, 5, 8}  // flip + 270º
+}};
+
+constexpr bool same_cell_map(const array<array<short, 9>, 8>& a, const array<array<short, 9>, 8>& b) {
+    for(int t = 0; t < 8; t++)
+        for(int i = 0; i < 9; i++)
+            if(a[t][i] != b[t][i])
+                return false;
+    return true;
+}
+static_assert(same_cell_map(SYMMETRY_T<3>::cell_map, CLASSIC_CELL_MAP), "The 3x3 cell map differs from the classic table");
+
+/**
+ * @brief Rotates the board 90 degrees clockwise
+ * @param raw_grid The original grid (before rotating)
+ * @return the new rotated board grid
+ */
+template<int N>
+vector<char> SYMMETRY_T<N>::rotate_grid(const vector<char>& raw_grid) {
+    vector<char> new_grid(CELLS);
+    for(int i =0; i<N; i++){
+        for(int j =0; j<N; j++){
+            new_grid[i * N + j] = raw_grid[(N-1-j) * N + i];
+        }
+    }
+    return new_grid;
+}
+
+/**
+ * @brief Flips a grid horizontaly
+ * @param raw_grid The original grid (before flipping)
+ * @return the new flipped grid
+ */
+template<int N>
+vector<char> SYMMETRY_T<N>::flip_grid(const vector<char>& raw_grid) {
+    vector<char> flipped = raw_grid;
+    for(int r = 0; r < N; ++r) {
+        // Swap col c and col N-1 - c
+        for(int c = 0; c < N / 2; ++c)
+            swap(flipped[r*N + c], flipped[r*N + N-1 - c]);
+    }
+    return flipped;
+}
+
+/**
+ * @brief Rotates a move pair 90 degrees clockwise
+ * @param raw_move The original move pair (before rotating)
+ * @return the new rotated move pair
+ */
+template<int N>
+pair<short, short> SYMMETRY_T<N>::rotate_move(const pair<short, short>& raw_move) {
+    return {raw_move.second, N-1 - raw_move.first};
+}
+
+/**
+ * @brief Flips a move horizontaly
+ * @param raw_move The original move pair (before flipping)
+ * @return the new flipped move pair
+ */
+template<int N>
+pair<short, short> SYMMETRY_T<N>::flip_move(const pair<short, short>& raw_move) {
+    return {raw_move.first, N-1 - raw_move.second};
+}
+
+/**
+ * @brief Finds the "Canonical" (standard) form of the board.
+ * Checks all 4 rotations and horizontal symmetry and returns the one that is lexicographically smallest.
+ * This ensures 0º, 90º , 180º , 270º and symmetrical versions of the same board
+ * all map to the same entry in the genomes map.
+ * @param raw_grid the original grid
+ * @param raw_move pair<x, y> the original move leading to the grid
+ * @param rotation the number of 90º rotations to get the canon board
+ * @param flip if the canon board was flipped or not
+ * @return pair<Canonical Grid, pair<rotated movement>>
+ */
+template<int N>
+pair<vector<char>, pair<short, short>> SYMMETRY_T<N>::get_canonical(
+    const vector<char>& raw_grid,
+    const pair<short, short>& raw_move,
+    int *rotation,
+    bool *flip
+) {
+    vector<char> canon_grid = raw_grid;
+    vector<char> curr_grid(CELLS);
+    int canon_transform = 0;
+    bool move_on_board = raw_move.first >= 0 && raw_move.first < N && raw_move.second >= 0 && raw_move.second < N;
+
+    // Try the 7 other images, in the order (flip, rotation) = (0, 1) ... (1, 3); each one
+    // is written into the same buffer and only kept when it is lexicographically smaller
+    for(int t = 1; t < 8; t++) {
+        for(int i = 0; i < CELLS; i++)
+            curr_grid[cell_map[t][i]] = raw_grid[i];
+        if(curr_grid < canon_grid) {
+            canon_grid.swap(curr_grid);
+            canon_transform = t;
+        }
+    }
+
+    pair<short, short> canon_move = raw_move;
+    if(move_on_board) {
+        short cell = cell_map[canon_transform][raw_move.first * N + raw_move.second];
+        canon_move = {cell / N, cell % N};
+    }
+    if(rotation != NULL && flip != NULL) {
+        *rotation = canon_transform % 4;
+        *flip = canon_transform >= 4;
+    }
+
+    return {move(canon_grid), canon_move};
+}
+
+/**
+ * @brief Returns a canonical grid and move to it's raw input based on the number of
+ * rotations and wether it was flipped or not
+ * @param canon_grid the canon grid
+ * @param canon_move pair<x, y> the canon move leading to the grid
+ * @param rotation the number of 90º rotations to get the canon board
+ * @param flip if the canon board was flipped or not
+ * @return pair<Raw Grid, pair<raw movement>>
+ */
+template<int N>
+pair<vector<char>, pair<short, short>> SYMMETRY_T<N>::unget_canonical(
+    const vector<char>& canon_grid,
+    const pair<short, short>& canon_move,
+    const int& rotation,
+    const bool& flip
+) {
+    vector<char> raw_grid = canon_grid;
+    pair<short, short> raw_move = canon_move;
+
+    int rotations = (4 - rotation) % 4;
+
+    for(int r = 0; r < rotations; r++) {
+        raw_grid = rotate_grid(raw_grid);
+        raw_move = rotate_move(raw_move);
+    }
+    if(flip) {
+        raw_grid = flip_grid(raw_grid);
+        raw_move = flip_move(raw_move);
+    }
+
+    return {raw_grid, raw_move};
+}
+
+/**
+ * @brief Maps a cell index through a transform (raw board -> transformed board).
+ */
+template<int N>
+short SYMMETRY_T<N>::transform_cell(short cell, int rotation, bool flip) {
+    return cell_map[flip * 4 + rotation][cell];
+}
+
+/**
+ * @brief Maps a cell index back through a transform (transformed board -> raw board).
+ */
+template<int N>
+short SYMMETRY_T<N>::untransform_cell(short cell, int rotation, bool flip) {
+    short raw = cell_map[(4 - rotation) % 4][cell];
+    if(flip)
+        raw = cell_map[4][raw];
+    return raw;
+}
+
+/**
+ * @brief Lists one empty cell per class of equivalent moves.
+ * Finds the transforms that leave the board unchanged and keeps only the empty
+ * cells that have the smallest index among their images, so moves that lead to
+ * symmetric positions are expanded once. The cells stay in the real orientation
+ * of the board and in increasing order, so the first one of a class is the one kept.
+ * @param grid the board's grid
+ * @param moves output array with the representative cells
+ * @return the number of cells written to 'moves'
+ */
+template<int N>
+int SYMMETRY_T<N>::representative_moves(const vector<char>& grid, short moves[]) {
+    // Transforms (besides the identity) that map the board onto itself
+    int stabilizer[7];
+    int size = 0;
+    for(int t = 1; t < 8; t++) {
+        bool same = true;
+        for(int i = 0; i < CELLS && same; i++)
+            same = grid[cell_map[t][i]] == grid[i];
+        if(same)
+            stabilizer[size++] = t;
+    }
+
+    int count = 0;
+    for(short i = 0; i < CELLS; i++) {
+        if(grid[i] != EMPTY_CELL)
+            continue;
+        bool representative = true;
+        for(int s = 0; s < size && representative; s++)
+            representative = cell_map[stabilizer[s]][i] >= i;
+        if(representative)
+            moves[count++] = i;
+    }
+    return count;
+}
+
+/**
+ * @brief Maps every set cell of a bitboard through a transform.
+ * @param bits the cells (bit i is cell i)
+ * @param transform the transform id (flip*4 + rotation)
+ */
+template<int N>
+uint64_t SYMMETRY_T<N>::transform_bits(uint64_t bits, int transform) {
+    uint64_t mapped = 0;
+    for(; bits; bits &= bits - 1)
+        mapped |= 1ULL << cell_map[transform][__builtin_ctzll(bits)];
+    return mapped;
+}
+
+/**
+ * @brief Same as the grid version for a position given by the bitboards of both players.
+ * @param first the cells of one player
+ * @param second the cells of the other player
+ * @param moves output array with the representative cells
+ * @return the number of cells written to 'moves'
+ */
+template<int N>
+int SYMMETRY_T<N>::representative_moves(uint64_t first, uint64_t second, short moves[]) {
+    int stabilizer[7];
+    int size = 0;
+    for(int t = 1; t < 8; t++)
+        if(transform_bits(first, t) == first && transform_bits(second, t) == second)
+            stabilizer[size++] = t;
+
+    int count = 0;
+    for(short i = 0; i < CELLS; i++) {
+        if(((first | second) >> i) & 1)
+            continue;
+        bool representative = true;
+        for(int s = 0; s < size && representative; s++)
+            representative = cell_map[stabilizer[s]][i] >= i;
+        if(representative)
+            moves[count++] = i;
+    }
+    return count;
+}
+
+template class SYMMETRY_T<3>;
+template class SYMMETRY_T<4>;
+template class SYMMETRY_T<5>;
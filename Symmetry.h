@@ -0,0 +1,71 @@
+#ifndef SYMMETRY_H
+#define SYMMETRY_H
+
+#include <vector>
+#include <utility>
+#include "Board.h"
+
+using namespace std;
+
+/**
+ * @brief Builds the cell map of the 8 transforms of an NxN board at compile time.
+ * Rotating moves cell (x, y) to (y, N-1 - x), flipping moves it to (x, N-1 - y).
+ */
+template<int N>
+constexpr array<array<short, N * N>, 8> build_cell_map() {
+    array<array<short, N * N>, 8> map{};
+    for(int t = 0; t < 8; t++)
+        for(int x = 0; x < N; x++)
+            for(int y = 0; y < N; y++) {
+                int a = x, b = t >= 4 ? N - 1 - y : y;
+                for(int r = 0; r < t % 4; r++) {
+                    int tmp = a;
+                    a = b;
+                    b = N - 1 - tmp;
+                }
+                map[t][x * N + y] = (short)(a * N + b);
+            }
+    return map;
+}
+
+/**
+ * @class SYMMETRY_T
+ * @brief Rotations and flips of the NxN board, shared by the bots and the searches.
+ *
+ * A transform is identified by (rotation, flip) and means "flip first if 'flip'
+ * is set, then rotate 90 degrees clockwise 'rotation' times". Its id is flip*4 + rotation.
+ */
+template<int N>
+class SYMMETRY_T {
+public:
+    static constexpr int CELLS = N * N;
+    // cell_map[t][i] is the cell that cell 'i' moves to under the transform with id 't'
+    static constexpr array<array<short, CELLS>, 8> cell_map = build_cell_map<N>();
+
+    static vector<char> rotate_grid(const vector<char>& raw_grid);
+    static vector<char> flip_grid(const vector<char>& raw_grid);
+    static pair<short, short> rotate_move(const pair<short, short>& raw_move);
+    static pair<short, short> flip_move(const pair<short, short>& raw_move);
+
+    static pair<vector<char>, pair<short, short>> get_canonical(
+        const vector<char>& raw_grid, const pair<short, short>& raw_move, int *rotation, bool *flip);
+    static pair<vector<char>, pair<short, short>> unget_canonical(
+        const vector<char>& canon_grid, const pair<short, short>& canon_move, const int& rotation, const bool& flip);
+
+    static short transform_cell(short cell, int rotation, bool flip);
+    static short untransform_cell(short cell, int rotation, bool flip);
+    static int representative_moves(const vector<char>& grid, short moves[]);
+
+    // Bitboard versions (bit i is cell i), for the searches that do not keep a grid
+    static uint64_t transform_bits(uint64_t bits, int transform);
+    static int representative_moves(uint64_t first, uint64_t second, short moves[]);
+};
+
+// Instantiated in Symmetry.cpp
+extern template class SYMMETRY_T<3>;
+extern template class SYMMETRY_T<4>;
+extern template class SYMMETRY_T<5>;
+
+typedef SYMMETRY_T<3> SYMMETRY;
+
+#endif // SYMMETRY_H
@@ -0,0 +1,228 @@
+#ifndef TOURNAMENT_CPP
+#define TOURNAMENT_CPP
+
+#include <vector>
+#include <map>
+#include <set>
+#include <numeric>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include "Rating.cpp"
+using namespace std;
+
+// Pairing rules of TOURNAMENT
+#define TOURNAMENT_SWISS 0          // Neighbours in the standings who have not met yet
+#define TOURNAMENT_ROUND_ROBIN 1    // Everyone meets everyone inside groups of TOURNAMENT_GROUP
+#define TOURNAMENT_KING 2           // The leader defends against the best challenger it has not met
+#define TOURNAMENT_UNCERTAIN 3      // Contenders for the lead play their closest opponents (needs ratings)
+// Individuals of a round-robin group (even)
+#define TOURNAMENT_GROUP 4
+// Games two versions play with the same sides before their rematches reuse the tally
+#define TOURNAMENT_SAMPLES 3
+
+/**
+ * @brief A game to play: 'first' moves first ('X'), 'second' plays 'O'.
+ */
+struct MATCH {
+    int first, second;
+};
+
+/**
+ * @class TOURNAMENT
+ * @brief Chooses the pairings of each round of bot-vs-bot games and remembers their results.
+ *
+ * A round is a set of matches where every individual appears at most once, so its
+ * matches are independent work units that can be played in parallel. Individuals are
+ * told apart by a version (a fingerprint of their genomes): the games between two
+ * versions are tallied by who played 'X', and the scheduler avoids rematches so each
+ * game adds information about the ranking. The games are random, so a rematch that
+ * cannot be avoided is played until the pair has TOURNAMENT_SAMPLES games with those
+ * sides; later ones reuse the tally (a win for the side with more wins, else a draw).
+ * Two individuals with the same version are always played.
+ * - Swiss: sorts by score and pairs each individual with the next one it has not met,
+ *   since games between close scores separate the standings the most.
+ * - Round-robin: splits the population into groups of TOURNAMENT_GROUP and plays one
+ *   round of the circle method inside every group, so a group is complete after
+ *   TOURNAMENT_GROUP - 1 rounds.
+ * - King of the hill: the leader plays the highest challenger it has not met, and the
+ *   others are paired as in the Swiss rule.
+ * - Uncertain: the individuals that may still be better than the leader, from the highest
+ *   optimistic skill (mu + 2 sigma) down, each play the free opponent they have not met
+ *   with the best match quality (the most open game against the best-known opponent).
+ *   The games go where the top of the ranking is least known, and an individual the
+ *   leader is known to beat only plays as someone's opponent.
+ */
+class TOURNAMENT {
+    private:
+    // Wins, draws and losses of 'first' (playing 'X') against 'second', by their versions
+    map<pair<uint64_t, uint64_t>, array<int, 3>> results;
+
+    bool met(uint64_t a, uint64_t b) const {
+        return results.count({a, b}) || results.count({b, a});
+    }
+
+    static vector<int> standings(const vector<int>& scores) {
+        vector<int> order(scores.size());
+        iota(order.begin(), order.end(), 0);
+        stable_sort(order.begin(), order.end(), [&scores](int a, int b) { return scores[a] > scores[b]; });
+        return order;
+    }
+
+    /**
+     * @brief Pairs the individuals of 'order' that are not taken, each with the next one it has not met.
+     */
+    void swiss(const vector<int>& order, const vector<uint64_t>& versions, vector<bool>& taken, vector<MATCH>& round) const {
+        for(size_t i = 0; i < order.size(); i++) {
+            int a = order[i];
+            if(taken[a])
+                continue;
+            int partner = -1;
+            for(size_t j = i + 1; j < order.size(); j++) {
+                int b = order[j];
+                if(taken[b])
+                    continue;
+                if(partner == -1)
+                    partner = b;
+                if(!met(versions[a], versions[b])) {
+                    partner = b;
+                    break;
+                }
+            }
+            // An odd individual out sits this round
+            if(partner == -1)
+                continue;
+            taken[a] = taken[partner] = true;
+            round.push_back({a, partner});
+        }
+    }
+
+    /**
+     * @brief Pairs the contenders for the lead first, each with its best-quality opponent.
+     */
+    void uncertain(const vector<RATING>& ratings, const vector<uint64_t>& versions, vector<bool>& taken, vector<MATCH>& round) const {
+        RATING_SYSTEM system;
+        vector<int> order(ratings.size());
+        iota(order.begin(), order.end(), 0);
+        stable_sort(order.begin(), order.end(), [&ratings](int a, int b) { return ratings[a].mu + 2 * ratings[a].sigma > ratings[b].mu + 2 * ratings[b].sigma; });
+        int leader = 0;
+        for(int i = 1; i < (int)ratings.size(); i++)
+            if(ratings[i].mu > ratings[leader].mu)
+                leader = i;
+        for(int a : order) {
+            // Individuals the leader is already known to beat only play as opponents
+            if(taken[a] || (a != leader && RATING_SYSTEM::better(ratings[leader], ratings[a]) >= RATING_CONFIDENCE))
+                continue;
+            // An opponent already met only if no other is free
+            int partner = -1;
+            double best = -1;
+            for(int b : order) {
+                if(taken[b] || b == a)
+                    continue;
+                double value = system.quality(ratings[a], ratings[b]) + (met(versions[a], versions[b]) ? 0 : 1);
+                if(value > best) {
+                    best = value;
+                    partner = b;
+                }
+            }
+            if(partner == -1)
+                continue;
+            taken[a] = taken[partner] = true;
+            round.push_back({a, partner});
+        }
+    }
+
+    public:
+    // TOURNAMENT_SWISS, TOURNAMENT_ROUND_ROBIN, TOURNAMENT_KING or TOURNAMENT_UNCERTAIN
+    int mode;
+    // Matches played and matches answered from the kept results
+    long long played, reused;
+
+    TOURNAMENT(int mode = TOURNAMENT_SWISS) : mode(mode), played(0), reused(0) {}
+
+    /**
+     * @brief Pairs the individuals for one round.
+     * @param scores current score of every individual
+     * @param versions fingerprint of every individual's genomes
+     * @param number index of the round (picks the round-robin round)
+     * @param ratings rating of every individual (TOURNAMENT_UNCERTAIN pairs as Swiss without them)
+     */
+    vector<MATCH> pair_round(const vector<int>& scores, const vector<uint64_t>& versions, int number,
+                             const vector<RATING>* ratings = NULL) {
+        // Results of versions that left the population are not needed anymore
+        set<uint64_t> alive(versions.begin(), versions.end());
+        for(auto it = results.begin(); it != results.end(); )
+            it = alive.count(it->first.first) && alive.count(it->first.second) ? next(it) : results.erase(it);
+
+        int n = scores.size();
+        vector<MATCH> round;
+        vector<bool> taken(n, false);
+        if(mode == TOURNAMENT_ROUND_ROBIN) {
+            // Circle method: the first member stays, the others rotate, and the two ends meet
+            const int rounds = TOURNAMENT_GROUP - 1;
+            int circle[TOURNAMENT_GROUP] = {0};
+            for(int i = 1; i < TOURNAMENT_GROUP; i++)
+                circle[i] = 1 + (i - 1 + number) % rounds;
+            for(int start = 0; start + 1 < n; start += TOURNAMENT_GROUP) {
+                int size = min(TOURNAMENT_GROUP, n - start);
+                for(int k = 0; k < TOURNAMENT_GROUP / 2; k++) {
+                    int a = circle[k], b = circle[TOURNAMENT_GROUP - 1 - k];
+                    if(a < size && b < size)
+                        round.push_back({start + a, start + b});
+                }
+            }
+            return round;
+        }
+
+        if(mode == TOURNAMENT_UNCERTAIN && ratings != NULL) {
+            uncertain(*ratings, versions, taken, round);
+            return round;
+        }
+
+        vector<int> order = standings(scores);
+        if(mode == TOURNAMENT_KING && n >= 2) {
+            int king = order[0], challenger = order[1];
+            for(int i = 1; i < n; i++)
+                if(!met(versions[king], versions[order[i]])) {
+                    challenger = order[i];
+                    break;
+                }
+            taken[king] = taken[challenger] = true;
+            round.push_back({king, challenger});
+        }
+        swiss(order, versions, taken, round);
+        return round;
+    }
+
+    /**
+     * @brief Finds the result of a rematch in the tally of two versions.
+     * @param result receives the result for 'first' (WIN, DRAW or LOSS)
+     * @return false if the match has to be played: the versions are the same or have
+     * played fewer than TOURNAMENT_SAMPLES games with these sides
+     */
+    bool cached(uint64_t first, uint64_t second, short& result) {
+        if(first == second)
+            return false;
+        auto found = results.find({first, second});
+        if(found == results.end())
+            return false;
+        const array<int, 3>& tally = found->second;
+        if(tally[0] + tally[1] + tally[2] < TOURNAMENT_SAMPLES)
+            return false;
+        result = tally[0] > tally[2] ? WIN : tally[0] < tally[2] ? LOSS : DRAW;
+        reused++;
+        return true;
+    }
+
+    /**
+     * @brief Adds the result of a match that was played to the tally of its versions.
+     */
+    void record(uint64_t first, uint64_t second, short result) {
+        played++;
+        if(first == second)
+            return;
+        results[{first, second}][result == WIN ? 0 : result == DRAW ? 1 : 2]++;
+    }
+};
+
+#endif // TOURNAMENT_CPP
@@ -0,0 +1,94 @@
+#ifndef TRANSPOSITION_TABLE_CPP
+#define TRANSPOSITION_TABLE_CPP
+
+#include <atomic>
+#include <vector>
+#include <cstdint>
+using namespace std;
+
+// Bound stored with a score
+#define TT_EXACT 1
+#define TT_LOWER 2 // The score is at least the stored value (beta cutoff)
+#define TT_UPPER 3 // The score is at most the stored value (no move raised alpha)
+
+/**
+ * @class TRANSPOSITION_TABLE
+ * @brief Fixed-size hash table of searched positions, shared by the search threads without locks.
+ *
+ * Each slot holds two atomic words: the entry data and the position key xor-ed with
+ * the data. A reader only trusts a slot when both words agree with its key, so a slot
+ * torn by two threads writing at the same time just looks like a miss.
+ * Data layout: bits 0-31 score, 32-39 best cell, 40-47 depth, 48-49 bound.
+ */
+class TRANSPOSITION_TABLE {
+    private:
+    struct SLOT {
+        atomic<uint64_t> check;  // key ^ data
+        atomic<uint64_t> data;
+    };
+    vector<SLOT> slots;
+    uint64_t mask;
+
+    public:
+    struct ENTRY {
+        int score;
+        short cell;
+        short depth;
+        short bound;
+    };
+
+    /**
+     * @brief Creates an empty table.
+     * @param size_log2 the table holds 2^size_log2 slots (16 bytes each)
+     */
+    TRANSPOSITION_TABLE(int size_log2 = 20) : slots(1ULL << size_log2), mask((1ULL << size_log2) - 1) {
+        clear();
+    }
+
+    /**
+     * @brief Empties every slot. Must not run while a search is using the table.
+     */
+    void clear(void) {
+        for(auto& slot : slots) {
+            slot.check.store(0, memory_order_relaxed);
+            slot.data.store(0, memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Looks a position up.
+     * @param key the position's hash (never 0)
+     * @param entry output with the stored entry
+     * @return true if the position was found
+     */
+    bool probe(uint64_t key, ENTRY& entry) const {
+        const SLOT& slot = slots[key & mask];
+        uint64_t data = slot.data.load(memory_order_relaxed);
+        uint64_t check = slot.check.load(memory_order_relaxed);
+        if((check ^ data) != key || data == 0)
+            return false;
+        entry.score = (int32_t)(uint32_t)data;
+        entry.cell = (short)((data >> 32) & 0xFF);
+        entry.depth = (short)((data >> 40) & 0xFF);
+        entry.bound = (short)((data >> 48) & 0x3);
+        return true;
+    }
+
+    /**
+     * @brief Stores a position, replacing the slot unless it holds a deeper result for the same key.
+     */
+    void store(uint64_t key, int score, short cell, short depth, short bound) {
+        SLOT& slot = slots[key & mask];
+        uint64_t old_data = slot.data.load(memory_order_relaxed);
+        uint64_t old_check = slot.check.load(memory_order_relaxed);
+        if((old_check ^ old_data) == key && (short)((old_data >> 40) & 0xFF) > depth)
+            return;
+
+        uint64_t data = (uint64_t)(uint32_t)score | ((uint64_t)(cell & 0xFF) << 32)
+                      | ((uint64_t)(depth & 0xFF) << 40) | ((uint64_t)(bound & 0x3) << 48);
+        slot.data.store(data, memory_order_relaxed);
+        slot.check.store(key ^ data, memory_order_relaxed);
+    }
+};
+
+#endif // TRANSPOSITION_TABLE_CPP
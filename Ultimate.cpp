@@ -0,0 +1,452 @@
+#ifndef ULTIMATE_CPP
+#define ULTIMATE_CPP
+
+#include <iostream>
+#include <chrono>
+#include <cstdint>
+#include "Board.h"
+using namespace std;
+
+// Search depth limit of the ultimate tic-tac-toe player
+#define ULTIMATE_MAX_DEPTH 64
+
+/**
+ * @brief Marks every 9-bit set of cells of a 3x3 board that holds a line.
+ */
+constexpr array<bool, 512> build_line_table() {
+    array<bool, 512> table{};
+    for(int cells = 0; cells < 512; cells++)
+        for(auto mask : build_line_masks<3, 3, 3>())
+            if((cells & mask) == mask)
+                table[cells] = true;
+    return table;
+}
+
+/**
+ * @class ULTIMATE_BOARD
+ * @brief Ultimate tic-tac-toe: nine 3x3 boards and a macro board made of their results.
+ *
+ * Each small board is a pair of 9-bit bitboards, like BOARD's, and the macro board
+ * holds the small boards won by each player. A move in cell c of a small board sends
+ * the opponent to small board c, unless that board is already won or full, in which
+ * case the opponent may play on any open board. Cells are numbered board * 9 + cell,
+ * and the (row, col) used by make_move is the position on the 9x9 grid.
+ * The board never allocates: the moves made are kept in a fixed stack for undo_move.
+ */
+class ULTIMATE_BOARD {
+    public:
+    static constexpr int CELLS = 81;
+    static constexpr array<bool, 512> has_line = build_line_table();
+
+    private:
+    struct UNDO {
+        uint8_t cell;
+        int8_t next_board;
+        uint16_t closed;
+        char winner;
+    };
+
+    uint16_t small[2][9];       // Cells taken by 'X' [0] and by 'O' [1] on each small board
+    uint16_t macro[2];          // Small boards won by 'X' [0] and by 'O' [1]
+    uint16_t closed;            // Small boards that are won or full
+    int next_board;             // Small board the player to move is sent to, -1 for any open board
+    int side;                   // Player to move (0 = 'X', 1 = 'O')
+    char winner;
+    UNDO history[CELLS];
+    int moves_made;
+
+    public:
+    ULTIMATE_BOARD(char first = 'X') {
+        reset_board(first);
+    }
+
+    /**
+     * @brief Empties every board.
+     * @param first the symbol that moves first
+     */
+    void reset_board(char first = 'X') {
+        for(int b = 0; b < 9; b++)
+            small[0][b] = small[1][b] = 0;
+        macro[0] = macro[1] = 0;
+        closed = 0;
+        next_board = -1;
+        side = first == 'O';
+        winner = EMPTY_CELL;
+        moves_made = 0;
+    }
+
+    char get_to_move(void) const {
+        return side ? 'O' : 'X';
+    }
+
+    int get_next_board(void) const {
+        return next_board;
+    }
+
+    /**
+     * @brief Gets the symbol on a cell of the 9x9 grid.
+     */
+    char get_cell(short int x, short int y) const {
+        if(x < 0 || x >= 9 || y < 0 || y >= 9)
+            return '?';
+        int b = (x / 3) * 3 + y / 3, c = (x % 3) * 3 + y % 3;
+        return (small[0][b] >> c & 1) ? 'X' : (small[1][b] >> c & 1) ? 'O' : EMPTY_CELL;
+    }
+
+    /**
+     * @brief Gets the terminal status of the game (ONGOING, X_WINS, O_WINS or DRAWN).
+     * The game is drawn when every small board is closed and nobody won the macro board.
+     */
+    int get_status(void) const {
+        if(winner != EMPTY_CELL)
+            return winner == 'X' ? X_WINS : O_WINS;
+        return closed == 0x1FF ? DRAWN : ONGOING;
+    }
+
+    char get_winner(void) const {
+        return winner;
+    }
+
+    /**
+     * @brief Lists the legal moves under the send-to rule.
+     * @param moves output array with room for 81 cells (board * 9 + cell)
+     * @return the number of moves, 0 if the game is over
+     */
+    int generate_moves(uint8_t moves[CELLS]) const {
+        if(winner != EMPTY_CELL)
+            return 0;
+        int count = 0;
+        int first = next_board >= 0 ? next_board : 0, last = next_board >= 0 ? next_board : 8;
+        for(int b = first; b <= last; b++) {
+            if(closed >> b & 1)
+                continue;
+            for(unsigned empty = ~(small[0][b] | small[1][b]) & 0x1FF; empty; empty &= empty - 1)
+                moves[count++] = (uint8_t)(b * 9 + __builtin_ctz(empty));
+        }
+        return count;
+    }
+
+    /**
+     * @brief Plays a legal move for the player to move, without validating it.
+     * Only the lines of the small board played on, and of the macro board when it is won, are checked.
+     */
+    void do_move(int cell) {
+        int b = cell / 9, c = cell % 9;
+        history[moves_made++] = {(uint8_t)cell, (int8_t)next_board, closed, winner};
+
+        uint16_t mine = small[side][b] |= (uint16_t)(1 << c);
+        if(has_line[mine]) {
+            macro[side] |= (uint16_t)(1 << b);
+            closed |= (uint16_t)(1 << b);
+            if(has_line[macro[side]])
+                winner = side ? 'O' : 'X';
+        }
+        else if((mine | small[!side][b]) == 0x1FF)
+            closed |= (uint16_t)(1 << b);
+
+        next_board = (closed >> c & 1) ? -1 : c;
+        side = !side;
+    }
+
+    /**
+     * @brief Takes back the last move made with do_move.
+     */
+    void undo_move(void) {
+        const UNDO &u = history[--moves_made];
+        side = !side;
+        int b = u.cell / 9, c = u.cell % 9;
+        small[side][b] &= (uint16_t)~(1 << c);
+        // The small board was open before the move, so it was not won yet
+        macro[side] &= (uint16_t)~(1 << b);
+        closed = u.closed;
+        next_board = u.next_board;
+        winner = u.winner;
+    }
+
+    /**
+     * @brief Checks if a move of the 9x9 grid is legal for the player to move.
+     */
+    bool valid_move(short int x, short int y) const {
+        if(x < 0 || x >= 9 || y < 0 || y >= 9 || winner != EMPTY_CELL)
+            return false;
+        int b = (x / 3) * 3 + y / 3, c = (x % 3) * 3 + y % 3;
+        if((closed >> b & 1) || (next_board >= 0 && next_board != b))
+            return false;
+        return !((small[0][b] | small[1][b]) >> c & 1);
+    }
+
+    /**
+     * @brief Plays a move of the 9x9 grid if it is legal.
+     * @param player the symbol of the player, which must be the one to move
+     */
+    bool make_move(char player, short int x, short int y) {
+        if(player != get_to_move() || !valid_move(x, y))
+            return false;
+        do_move(((x / 3) * 3 + y / 3) * 9 + (x % 3) * 3 + y % 3);
+        return true;
+    }
+
+    /**
+     * @brief Gets the bitboard of a small board (side 0 = 'X', 1 = 'O').
+     */
+    uint16_t get_small(int side, int board) const {
+        return small[side][board];
+    }
+
+    uint16_t get_macro(int side) const {
+        return macro[side];
+    }
+
+    uint16_t get_closed(void) const {
+        return closed;
+    }
+
+    /**
+     * @brief Prints the 9x9 grid, with the small boards won shown on the right.
+     */
+    void draw_board(void) const {
+        string separator = "+-------+-------+-------+";
+        for(int x = 0; x < 9; x++) {
+            if(x % 3 == 0)
+                cout << separator << endl;
+            for(int y = 0; y < 9; y++)
+                cout << (y % 3 == 0 ? "| " : "") << get_cell(x, y) << " ";
+            cout << "|";
+            if(x % 3 == 1) {
+                cout << "   ";
+                for(int b = x / 3 * 3; b < x / 3 * 3 + 3; b++)
+                    cout << ((macro[0] >> b & 1) ? 'X' : (macro[1] >> b & 1) ? 'O' : (closed >> b & 1) ? '-' : '.');
+            }
+            cout << endl;
+        }
+        cout << separator << endl;
+        if(next_board >= 0 && winner == EMPTY_CELL)
+            cout << "Next small board: row " << next_board / 3 + 1 << ", column " << next_board % 3 + 1 << endl;
+    }
+
+    /**
+     * @brief Counts the positions 'depth' moves ahead (leaves of the move-generation tree).
+     * The last level is counted without being played.
+     */
+    long long perft(int depth) {
+        uint8_t moves[CELLS];
+        int count = generate_moves(moves);
+        if(depth <= 1)
+            return depth == 1 ? count : 1;
+        long long total = 0;
+        for(int m = 0; m < count; m++) {
+            do_move(moves[m]);
+            total += perft(depth - 1);
+            undo_move();
+        }
+        return total;
+    }
+};
+
+/**
+ * @class ULTIMATE_SEARCH
+ * @brief Alpha-beta player for ultimate tic-tac-toe, with iterative deepening under a time budget.
+ * The game is far too big to solve, so positions at the depth limit are scored by the
+ * lines of the macro board and of the open small boards that are still open for one player.
+ */
+class ULTIMATE_SEARCH {
+    static constexpr int WIN_SCORE = 1 << 20;
+
+    private:
+    long long nodes;
+    chrono::steady_clock::time_point start;
+    bool stopped;
+
+    /**
+     * @brief Scores lines still open for one player: 'a' of its marks and none of the opponent's.
+     */
+    static int line_score(unsigned mine, unsigned theirs, const int weight[4]) {
+        int score = 0;
+        for(auto mask : BOARD::line_masks) {
+            int a = __builtin_popcountll(mine & mask), b = __builtin_popcountll(theirs & mask);
+            if(b == 0)
+                score += weight[a];
+            else if(a == 0)
+                score -= weight[b];
+        }
+        return score;
+    }
+
+    int evaluate(const ULTIMATE_BOARD &board, int me) const {
+        static const int macro_weight[4] = {0, 40, 300, 0};
+        static const int small_weight[4] = {0, 1, 6, 0};
+        int score = line_score(board.get_macro(me), board.get_macro(!me), macro_weight);
+        for(int b = 0; b < 9; b++)
+            if(!(board.get_closed() >> b & 1))
+                score += line_score(board.get_small(me, b), board.get_small(!me, b), small_weight);
+        return score;
+    }
+
+    int negamax(ULTIMATE_BOARD &board, int depth, int ply, int alpha, int beta) {
+        nodes++;
+        if((nodes & 1023) == 0 && time_budget_ms > 0 &&
+            chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() >= time_budget_ms)
+            stopped = true;
+        if(stopped)
+            return 0;
+        if(board.get_winner() != EMPTY_CELL)
+            return -(WIN_SCORE - ply);
+        uint8_t moves[ULTIMATE_BOARD::CELLS];
+        int count = board.generate_moves(moves);
+        if(count == 0)
+            return 0;
+        if(depth == 0)
+            return evaluate(board, board.get_to_move() == 'O');
+
+        int best = -WIN_SCORE - 1;
+        for(int m = 0; m < count; m++) {
+            board.do_move(moves[m]);
+            int score = -negamax(board, depth - 1, ply + 1, -beta, -alpha);
+            board.undo_move();
+            if(stopped)
+                return 0;
+            best = max(best, score);
+            alpha = max(alpha, best);
+            if(alpha >= beta)
+                break;
+        }
+        return best;
+    }
+
+    public:
+    struct Move {
+        int row, col;
+    };
+
+    struct SearchStats {
+        long long nodes;
+        double time_ms;
+        int depth;          // Last depth the search completed
+    };
+
+    // Deepest search and time per move (0 means no time limit)
+    int max_depth;
+    double time_budget_ms;
+
+    ULTIMATE_SEARCH(int max_depth = ULTIMATE_MAX_DEPTH, double time_budget_ms = 100)
+        : nodes(0), stopped(false), max_depth(max_depth), time_budget_ms(time_budget_ms) {}
+
+    /**
+     * @brief Returns the best move for the player to move found within the budget.
+     */
+    Move findBestMove(ULTIMATE_BOARD &board, SearchStats *stats = NULL) {
+        start = chrono::steady_clock::now();
+        nodes = 0;
+        stopped = false;
+        uint8_t moves[ULTIMATE_BOARD::CELLS];
+        int count = board.generate_moves(moves);
+        if(count == 0)
+            return {-1, -1};
+
+        int best_cell = moves[0], completed = 0;
+        for(int depth = 1; depth <= max_depth && depth <= ULTIMATE_BOARD::CELLS; depth++) {
+            int alpha = -WIN_SCORE - 1, best = -WIN_SCORE - 1, cell = moves[0];
+            for(int m = 0; m < count; m++) {
+                board.do_move(moves[m]);
+                int score = -negamax(board, depth - 1, 1, -WIN_SCORE - 1, -alpha);
+                board.undo_move();
+                if(stopped)
+                    break;
+                if(score > best) {
+                    best = score;
+                    cell = moves[m];
+                }
+                alpha = max(alpha, best);
+            }
+            if(stopped)
+                break;
+            best_cell = cell;
+            completed = depth;
+            // The best move of this depth is searched first in the next one
+            for(int m = 1; m < count; m++)
+                if(moves[m] == best_cell)
+                    swap(moves[0], moves[m]);
+            if(best > WIN_SCORE - 256 || best < 256 - WIN_SCORE)
+                break;
+        }
+
+        if(stats != NULL) {
+            stats->nodes = nodes;
+            stats->depth = completed;
+            stats->time_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        }
+        int b = best_cell / 9, c = best_cell % 9;
+        return {(b / 3) * 3 + c / 3, (b % 3) * 3 + c % 3};
+    }
+};
+
+/**
+ * @class TicTacToeUltimate
+ * @brief Plays a game of ultimate tic-tac-toe between two players, each one a search or the user.
+ */
+class TicTacToeUltimate {
+    private:
+    ULTIMATE_BOARD board;
+    ULTIMATE_SEARCH* players[2]; // 'X' [0] and 'O' [1], NULL for the user
+
+    public:
+    TicTacToeUltimate(ULTIMATE_SEARCH* x, ULTIMATE_SEARCH* o) : board(), players{x, o} {}
+
+    /**
+     * @brief Runs a game, 'X' moves first.
+     * @return the result for 'X' (WIN, LOSS or DRAW)
+     */
+    short run_game(const bool& print = true) {
+        board.reset_board('X');
+        while(board.get_status() == ONGOING) {
+            if(print)
+                board.draw_board();
+            char symbol = board.get_to_move();
+            ULTIMATE_SEARCH* player = players[symbol == 'O'];
+            int x = -1, y = -1;
+            if(player != NULL) {
+                ULTIMATE_SEARCH::SearchStats stats;
+                ULTIMATE_SEARCH::Move move = player->findBestMove(board, &stats);
+                x = move.row;
+                y = move.col;
+                if(print)
+                    cout << "Player " << symbol << " (Search) plays: " << x + 1 << ", " << y + 1 << " (depth "
+                         << stats.depth << ", " << stats.nodes << " nodes)" << endl;
+            }
+            else {
+                while(!board.valid_move(x, y)) {
+                    cout << "Choose a valid row (1-9) and a collumn (1-9)";
+                    if(!(cin >> x >> y))
+                        return DRAW;
+                    x--; y--;
+                }
+            }
+            board.make_move(symbol, x, y);
+        }
+
+        if(print) {
+            board.draw_board();
+            if(board.get_status() == DRAWN)
+                cout << "It's a draw!\n";
+            else
+                cout << "Player " << board.get_winner() << " won!\n";
+        }
+        return board.get_status() == X_WINS ? WIN : board.get_status() == O_WINS ? LOSS : DRAW;
+    }
+};
+
+/**
+ * @brief Counts the move-generation tree of the empty board, depth by depth, and its speed.
+ */
+inline void benchmark_ultimate(int max_depth = 5) {
+    ULTIMATE_BOARD board;
+    for(int depth = 1; depth <= max_depth; depth++) {
+        auto start = chrono::steady_clock::now();
+        long long leaves = board.perft(depth);
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        cout << "Perft " << depth << ": " << leaves << " positions, " << ms << " ms ("
+             << (ms > 0 ? leaves / ms / 1000.0 : 0) << " million moves/s)\n";
+    }
+}
+
+#endif // ULTIMATE_CPP
@@ -28,6 +28,8 @@ const char EMPTY_CELL = ' '; // Defines an empty cell for the game board
 class BOARD {
 private:
     short int used_cells; // Checks for a draw
+    char winner; // Symbol that completed a line, EMPTY_CELL if none
+    short int win_cells; // Value of used_cells when the line was completed
 
 public:
     vector<char> grid; // ' ', 'X' or 'O'
@@ -39,12 +41,14 @@ public:
         for (auto& symbol : grid)
             symbol = EMPTY_CELL;
         used_cells = 0;
+        winner = EMPTY_CELL;
+        win_cells = 0;
     }
 
     /**
      * @brief Constructs an empty Tic-Tac-Toe board.
      */
-    BOARD() : used_cells(0), grid(9) {
+    BOARD() : used_cells(0), winner(EMPTY_CELL), win_cells(0), grid(9) {
         reset_board();
     }
 
@@ -109,11 +113,44 @@ public:
         if(!valid_move(x, y))
             return false;      
         
-        grid[x*3 + y] = player;
-        used_cells++;
+        do_move(player, x*3 + y);
         return true;
     }
 
+    /**
+     * @brief Places a player's symbol without validating it (used by the searches).
+     * @param player The player's symbol ('X' or 'O').
+     * @param index The linear index of an empty cell (x*3 + y).
+     */
+    void do_move(char player, short int index) {
+        grid[index] = player;
+        used_cells++;
+        if(winner == EMPTY_CELL && check_win(index / 3, index % 3)) {
+            winner = player;
+            win_cells = used_cells;
+        }
+    }
+
+    /**
+     * @brief Takes back the last move made with do_move.
+     * @param index The linear index of the cell to empty.
+     */
+    void undo_move(short int index) {
+        if(winner != EMPTY_CELL && win_cells == used_cells) {
+            winner = EMPTY_CELL;
+            win_cells = 0;
+        }
+        grid[index] = EMPTY_CELL;
+        used_cells--;
+    }
+
+    /**
+     * @brief Returns the symbol that completed a line, or EMPTY_CELL.
+     */
+    char get_winner(void) const {
+        return winner;
+    }
+
     /**
      * @brief Checks if the last move resulted in a win.
      * @param x The row of the last move.
@@ -158,57 +195,21 @@ public:
 
 class Optimal_algorithm{
     private:
-        int evaluate(BOARD &b, char player, char opponent){
-        // Checking for Rows for X or O victory.
-        for(int row = 0; row<3; row++){
-            if(b.get_cell(row, 0) == b.get_cell(row, 1) &&
-                b.get_cell(row, 1) == b.get_cell(row, 2))
-            {
-                if(b.get_cell(row, 0) == player)
-                    return +10;
-                else if(b.get_cell(row,0) == opponent)
-                    return -10;
-            }
-        }
-        // Checking for Columns for X or O victory.
-        for(int col = 0; col<3; col++){
-            if(b.get_cell(0, col) == b.get_cell(1, col) &&
-                b.get_cell(1, col) == b.get_cell(2, col))
-            {
-                if(b.get_cell(0, col) == player)
-                    return +10;
-                else if(b.get_cell(0, col) == opponent)
-                    return -10;
-            }
-        }
-
-        // Checking for Diagonals for X or O victory.
-        if(b.get_cell(0,0) == b.get_cell(1,1) && 
-            b.get_cell(1,1) == b.get_cell(2,2))
-        {
-            if(b.get_cell(0, 0) == player)
-                return +10;
-            else if(b.get_cell(0,0) == opponent)
-                return -10;
-        }
-
-        if(b.get_cell(0,2) == b.get_cell(1,1) && 
-            b.get_cell(1,1) == b.get_cell(2,0))
-        {
-            if(b.get_cell(0,2) == player)
-                return +10;
-            else if(b.get_cell(0,2) == opponent)
-                return -10;
-        }
-        
-        // Else if none of them have won then return 0
+    /*Returns +10 if 'player' completed a line, -10 if 'opponent' did
+    and 0 otherwise. The winner is kept incrementally by the board*/
+    int evaluate(BOARD &b, char player, char opponent){
+        char winner = b.get_winner();
+        if(winner == player)
+            return +10;
+        else if(winner == opponent)
+            return -10;
         return 0;
     }
 
     /*This is the minimax function. It considers all
     the possible ways the game can go and returns
     the value of the board*/
-    int minimax(BOARD board, int depth, bool isMax, char algorithm, char bot){
+    int minimax(BOARD &board, int depth, bool isMax, char algorithm, char bot){
         int score = evaluate(board, algorithm, bot);
         
         /*If Maximizer has won the game return his/her
@@ -236,12 +237,14 @@ class Optimal_algorithm{
                     // Check if cell is empty
                     if(board.get_cell(i, j) == ' '){
                         // Make the move
-                        BOARD nb = board;
-                        nb.make_move(algorithm, i, j);
+                        board.do_move(algorithm, i*3 + j);
 
-                         // Call minimax recursively and choose
+                        // Call minimax recursively and choose
                         // the maximum value
-                        best = max(best, minimax(nb, depth+1, false, algorithm, bot));
+                        best = max(best, minimax(board, depth+1, false, algorithm, bot));
+
+                        // Undo the move
+                        board.undo_move(i*3 + j);
                     }
                 }
             }
@@ -258,13 +261,14 @@ class Optimal_algorithm{
                      // Check if cell is empty
                     if(board.get_cell(i, j) == ' '){
                         // Make the move
-                        BOARD nb = board;
-                        nb.make_move(bot, i, j);
-
+                        board.do_move(bot, i*3 + j);
 
                         // Call minimax recursively and choose
                         // the minimum value
-                        best = min(best, minimax(nb, depth+1, true, algorithm, bot));
+                        best = min(best, minimax(board, depth+1, true, algorithm, bot));
+
+                        // Undo the move
+                        board.undo_move(i*3 + j);
                     }
                 }
             }
@@ -291,12 +295,14 @@ public:
             for(int j = 0; j<3; j++){
                 // Check if cell is empty
                 if(board.get_cell(i, j) == ' '){
-                    // Make the move
-                    BOARD nb = board;
-                    nb.make_move(algorithm, i, j);
+                    // Make the move, the same board is used by the whole search
+                    board.do_move(algorithm, i*3 + j);
 
                     // compute evaluation function for this move.
-                    int moveVal = minimax(nb, 0, false, algorithm, bot);
+                    int moveVal = minimax(board, 0, false, algorithm, bot);
+
+                    // Undo the move
+                    board.undo_move(i*3 + j);
 
                     /*If the value of the current move is 
                     more than the best value, then update best*/
@@ -1,5 +1,43 @@
 #include "Play.cpp"
+#include "Proof_number.cpp"
+#include "Ultimate.cpp"
+#include "Qubic.cpp"
+#include "Enumerator.cpp"
+#include "Replay_trainer.cpp"
+#include "Canonical_batch.cpp"
+#include "Genome_matrix.cpp"
+#include "Steady_state.cpp"
+#include "Island.cpp"
+#include "Tournament.cpp"
+#include "Rating.cpp"
+#include <chrono>
+#include <random>
 #include <algorithm>
+#include <atomic>
+#include <new>
+
+#ifdef COUNT_ALLOCATIONS
+// Heap allocations made so far, counted by the global operator new below. Only the
+// build of 'make allocations' replaces the allocator, for the option 16 benchmark.
+atomic<long long> heap_allocations(0);
+
+// Not inlined, so the optimizer never pairs a new-expression with the free() below
+__attribute__((noinline)) void* operator new(size_t size) {
+    heap_allocations.fetch_add(1, memory_order_relaxed);
+    void* p = malloc(size ? size : 1);
+    if(p == NULL)
+        throw bad_alloc();
+    return p;
+}
+
+__attribute__((noinline)) void operator delete(void* p) noexcept {
+    free(p);
+}
+
+__attribute__((noinline)) void operator delete(void* p, size_t) noexcept {
+    free(p);
+}
+#endif
 
 // Config
 #define INDIVIDUALS 2
@@ -7,8 +45,28 @@ float MIN_MUT = 0.05, MAX_MUT = 0.3;
 float MUTATION_STEP = (MAX_MUT - MIN_MUT)*2;
 #define ROUNDS 6
 #define CROSSOVER_ROUNDS 5
+// 1 runs crossover and mutation on the population's genome matrix, 0 on each bot's map
+// (the games still read the maps, so the matrix is copied in and out every generation)
+#define DENSE_CROSSOVER 0
+// Time per move of the parallel minimax teacher on boards bigger than 3x3
+#define TEACHER_TIME_MS 20
+// Seed of every random number of a run (0 draws one from the random device)
+#define SEED 0
+// When the training games stop before the end: EARLY_OFF, EARLY_DRAWS or EARLY_FORCED
+#define EARLY_END EARLY_DRAWS
+// Pairing of the bot-vs-bot rounds: TOURNAMENT_SWISS, TOURNAMENT_ROUND_ROBIN, TOURNAMENT_KING or TOURNAMENT_UNCERTAIN
+#define TOURNAMENT_MODE TOURNAMENT_UNCERTAIN
+
+template<int ROWS, int COLS, int K>
+class POPULATION_T {
+    typedef BOARD_T<ROWS, COLS, K> BOARD;
+    typedef BOT_T<ROWS, COLS, K> BOT;
+    typedef Optimal_algorithm_T<ROWS, COLS, K> Optimal_algorithm;
+    typedef TicTacToeMiniMax_T<ROWS, COLS, K> TicTacToeMiniMax;
+    typedef TicTacToeBOT_T<ROWS, COLS, K> TicTacToeBOT;
+    typedef TicTacToePlayer_T<ROWS, COLS, K> TicTacToePlayer;
+    static constexpr int CELLS = ROWS * COLS;
 
-class POPULATION {
     private:
     // Stores the population and each individual's win rate
     vector<pair<BOT, int>> pop;
@@ -18,73 +76,161 @@ class POPULATION {
     int stagnation;
     // Current mutation rate
     float MUTATION_RATE;
+    // Seed of the run, generations made so far and the generator of the mutations and shuffles
+    uint64_t seed;
+    uint32_t generation;
+    PHILOX rng;
+    // Genomes of the whole population (rows 0..INDIVIDUALS-1) and of BEST (row INDIVIDUALS)
+    GENOME_MATRIX_T<ROWS, COLS, K> matrix;
+    // Skill estimate of every individual and of BEST, updated after each bot-vs-bot game
+    vector<RATING> ratings;
+    RATING best_rating;
+    RATING_SYSTEM rating_system;
+
+    /**
+     * @brief Prefix of the files saved by this variant ("" for the classic 3x3 board, "4x4k4_" for example).
+     */
+    static string file_prefix(void) {
+        if(BOARD::CLASSIC)
+            return "";
+        return to_string(ROWS) + "x" + to_string(COLS) + "k" + to_string(K) + "_";
+    }
+
+    /**
+     * @brief Points every individual's move choices at its own stream of the current generation.
+     */
+    void seek_individuals(void) {
+        for(int i = 0; i < INDIVIDUALS; i++) {
+            pop[i].first.rng.set_seed(seed);
+            pop[i].first.rng.seek(generation, i);
+        }
+    }
 
     public:
     /**
      * @brief creates a population of bots (alternating symbols) and with 0 wins.
      */
-    POPULATION() : pop(INDIVIDUALS), BEST(), stagnation(0), MUTATION_RATE(MIN_MUT) {
+    POPULATION_T() : pop(INDIVIDUALS), BEST(), stagnation(0), MUTATION_RATE(MIN_MUT),
+                     seed(SEED ? SEED : (uint64_t)random_device()() << 32 | random_device()()), generation(0),
+                     rng(seed), matrix(INDIVIDUALS + 1, seed), ratings(INDIVIDUALS) {
         for(int i = 0; i < INDIVIDUALS; i++) {
             BOT aux('X');
             pop[i] = {aux, 0};
         }
+        seek_individuals();
         
         BEST = {pop[0]};
         BEST.second = INT32_MIN;
     }
 
+    uint64_t get_seed(void) const {
+        return seed;
+    }
+
+    /**
+     * @brief Sorts the population (and the ratings with it) by score, the best first,
+     * and keeps the first individual as BEST if it scored more than BEST did.
+     */
+    void rank_population(void) {
+        vector<int> order(INDIVIDUALS);
+        iota(order.begin(), order.end(), 0);
+        stable_sort(order.begin(), order.end(), [this](int a, int b) { return pop[a].second > pop[b].second; });
+        vector<pair<BOT, int>> sorted_pop;
+        vector<RATING> sorted_ratings;
+        for(int i : order) {
+            sorted_pop.push_back(pop[i]);
+            sorted_ratings.push_back(ratings[i]);
+        }
+        pop.swap(sorted_pop);
+        ratings.swap(sorted_ratings);
+
+        // Updates BEST and the stagnation rate
+        if(BEST.second < pop[0].second) {
+            BEST = pop[0];
+            best_rating = ratings[0];
+            stagnation = 0;
+        }
+        else
+            stagnation++;
+    }
+
     void update_mutation_rate() {
         float factor = min(1.0, stagnation / 10.0); 
 
         MUTATION_RATE = MIN_MUT + (MAX_MUT - MIN_MUT) * factor;
     }
 
-    vector<long long> mutate(vector<long long> genome)
+    /**
+     * @brief Mutates a genome in place: each score has MUTATION_RATE chance of getting normal noise.
+     */
+    void mutate(typename BOT::GENOME& genome)
     {
-        vector<long long> mutated;
-        // Instead of using the old rand() from C, I am using the random library from C++. rd is the random device that we use to generate the pseudo-random numbers, and rng is the generator, using Mersenne-Twister algorithm.
-        random_device rd;
-        mt19937 rng(rd());
-
         // The chance of mutating is defined by a random applied into an uniform distribution, while the noise is defined by a random choose in a normal distribution
         uniform_real_distribution<double> chanceDist(0.0, 1.0);
         normal_distribution<double> noiseDist(0.0, MUTATION_STEP);
 
-        // This part of the code is the same, I just changed the calculations of the noise and the ceiling for the random number to use standard C++ functions.
         for (auto &g : genome)
         {
             if (chanceDist(rng) <= MUTATION_RATE)
             {
                 int noise = noiseDist(rng);
                 int m = g + static_cast<int>(std::round(noise));
-                m = std::max(1, m);
-                mutated.push_back(m);
+                g = std::max(1, m);
             }
-            else
-                mutated.push_back(g);
         }
-        return mutated;
     }
 
-    void crossover(void) {
-        // Sorting based on win rate
-        sort(pop.begin(), pop.end(), 
-            [](const pair<BOT, int>& a, const pair<BOT, int>& b) {return a.second > b.second;});
+    /**
+     * @brief Same generation as crossover(), built with dense passes over the genome matrix:
+     * every child averages BEST with one individual, copies the states only one of them
+     * knows and mutates the individual's states. Unlike mutate(), occupied cells stay at 0.
+     */
+    void crossover_matrix(void) {
+        rank_population();
+        update_mutation_rate();
+
+        for(int i = 0; i < INDIVIDUALS; i++)
+            matrix.load(i, pop[i].first);
+        matrix.load(INDIVIDUALS, BEST.first);
+
+        // The first child is BEST itself, the others cross BEST with individual i
+        vector<pair<int, int>> parents(INDIVIDUALS);
+        parents[0] = {INDIVIDUALS, INDIVIDUALS};
+        for(int i = 1; i < INDIVIDUALS; i++)
+            parents[i] = {INDIVIDUALS, i};
+        matrix.breed(parents, MUTATION_RATE, MUTATION_STEP, generation);
 
-        // the best crosses over with every other individual and creates a new population
         vector<pair<BOT, int>> new_pop;
-        // Updates BEST and the stagnation rate
-        if(BEST.second < pop[0].second) {
-            this->BEST.first = pop[0].first;
-            stagnation = 0;
+        new_pop.push_back(BEST);
+        ratings[0] = best_rating;
+        for(int i = 1; i < INDIVIDUALS; i++) {
+            BOT child('X');
+            matrix.store(i, child);
+            // Win rate is the average between the parent's last win rate
+            new_pop.push_back({child, (BEST.second + pop[i].second) / 2});
+            ratings[i] = RATING_SYSTEM::child(best_rating, ratings[i]);
         }
-        else
-            stagnation++;
+        pop = new_pop;
+        generation++;
+        seek_individuals();
+    }
 
+    void crossover(void) {
+        if(DENSE_CROSSOVER) {
+            crossover_matrix();
+            return;
+        }
+
+        rank_population();
+
+        // the best crosses over with every other individual and creates a new population
+        vector<pair<BOT, int>> new_pop;
         new_pop.push_back(BEST);
+        ratings[0] = best_rating;
             
         for(int i = 1; i < INDIVIDUALS; i++) {
             BOT child;
+            rng.seek(generation, i, PHILOX_MUTATION);
             //if(i % 2) child.symbol = 'X'; else child.symbol = 'O';
             // The child has all the BEST's genomes
             child.symbol = 'X';
@@ -93,7 +239,7 @@ class POPULATION {
             for(auto& [board_state, genome] : pop[i].first.genomes) {
                 if(child.genomes.count(board_state)) { // Both parents have this genome
                     // Average of both parent's genomes
-                    for(int j = 0; j < 9; j++) {
+                    for(int j = 0; j < CELLS; j++) {
                         child.genomes[board_state][j] += genome[j];
                         child.genomes[board_state][j] /= 2;
                     }
@@ -102,12 +248,47 @@ class POPULATION {
                     child.genomes[board_state] = genome;
                 // Applies mutation
                 update_mutation_rate();
-                child.genomes[board_state] = mutate(child.genomes[board_state]);
+                mutate(child.genomes[board_state]);
             }
             // Win rate is the average between the parent's last win rate
             new_pop.push_back({child, (BEST.second + pop[i].second) / 2});
+            ratings[i] = RATING_SYSTEM::child(best_rating, ratings[i]);
         }
         pop = new_pop;
+        generation++;
+        seek_individuals();
+    }
+
+    /**
+     * @brief Plays the matches of a round that have no kept result, split over the cores.
+     * Each match plays copies of its bots, so the matches only read the population.
+     * @param logs one game log per thread, or NULL
+     */
+    void play_matches(const vector<MATCH>& round, const vector<int>& to_play, vector<short>& results,
+                      int number, bool print, GAME_LOG_WRITER_T<ROWS, COLS, K>* logs) {
+        // Printed games are played one after the other
+        int workers = print ? 1 : (int)min<size_t>(max(1u, thread::hardware_concurrency()), to_play.size());
+        auto work = [&](int w) {
+            for(size_t t = w; t < to_play.size(); t += workers) {
+                const MATCH& match = round[to_play[t]];
+                TicTacToeBOT game(pop[match.first].first, pop[match.second].first);
+                game.players[0].symbol = 'X';
+                game.players[1].symbol = 'O';
+                // Every match draws from the streams of its two individuals in this round
+                game.players[0].rng.seek(generation, match.first, number);
+                game.players[1].rng.seek(generation, match.second, number);
+                game.game_log = logs == NULL ? NULL : &logs[w];
+                game.early_end = EARLY_END;
+                results[to_play[t]] = game.botVSbot(print);
+            }
+        };
+        vector<thread> pool;
+        for(int w = 1; w < workers; w++)
+            pool.emplace_back(work, w);
+        if(workers > 0)
+            work(0);
+        for(auto& t : pool)
+            t.join();
     }
 
     void train_population(bool print = false, bool save_load = false) {
@@ -117,67 +298,113 @@ class POPULATION {
                 string file_name = "X";
                 file_name.push_back(i + '0');
                 file_name.append(".txt");
-                p1.load_genomes(file_name);
+                p1.load_genomes(file_prefix() + file_name);
                 file_name[0] = 'O';
-                p1.load_genomes(file_name);
+                p1.load_genomes(file_prefix() + file_name);
                 pop[i] = {p1, 0};
                 pop[i+1] = {p2, 0};
             }
         }
 
-        // Setup Random Number Generator
-        auto rng = default_random_engine(time(NULL));
+        seek_individuals();
+        cout << "Seed: " << seed << endl;
+        // Every game is appended to the game log of this variant (one writer per thread of play_matches())
+        unique_ptr<GAME_LOG_WRITER_T<ROWS, COLS, K>[]> game_logs;
+        if(save_load) {
+            unsigned writers = max(1u, thread::hardware_concurrency());
+            game_logs.reset(new GAME_LOG_WRITER_T<ROWS, COLS, K>[writers]);
+            for(unsigned w = 0; w < writers; w++)
+                game_logs[w].open(file_prefix() + "games.log");
+        }
 
         pair<int, pair<int, int>> winrate_table[INDIVIDUALS];
         for (int i = 0; i < INDIVIDUALS; i++){
             winrate_table[i] = {0, {0, 0}};
         }
+        ratings.assign(INDIVIDUALS, RATING());
+        TOURNAMENT tournament(TOURNAMENT_MODE);
+        // Rounds and games played by the current generation
+        int generation_rounds = 0;
+        long long generation_games = 0;
         for(int j = 0; j < ROUNDS; j++) {
-            // This ensures random matchmaking every generation
-            shuffle(pop.begin(), pop.end(), rng);
+            // The scheduler pairs the individuals from their scores and the matches already played
+            vector<int> scores(INDIVIDUALS);
+            vector<uint64_t> versions(INDIVIDUALS);
+            for(int i = 0; i < INDIVIDUALS; i++) {
+                scores[i] = pop[i].second;
+                versions[i] = pop[i].first.fingerprint();
+            }
+            vector<MATCH> round = tournament.pair_round(scores, versions, j, &ratings);
+
+            // A rematch of versions with a full tally takes its result from it, the others are played
+            vector<short> results(round.size(), DRAW);
+            vector<int> to_play;
+            for(int m = 0; m < (int)round.size(); m++)
+                if(!tournament.cached(versions[round[m].first], versions[round[m].second], results[m]))
+                    to_play.push_back(m);
+            play_matches(round, to_play, results, j, print, game_logs.get());
+            // Only the games played are evidence: a kept result was already counted in the ratings
+            for(int m : to_play) {
+                tournament.record(versions[round[m].first], versions[round[m].second], results[m]);
+                rating_system.update(ratings[round[m].first], ratings[round[m].second], results[m]);
+            }
+            generation_games += to_play.size();
+            // The score that ranks the individuals is the skill they have with high confidence
+            for(int i = 0; i < INDIVIDUALS; i++)
+                pop[i].second = ratings[i].conservative();
 
             // Simulates rounds and generates new populations
-            for(int i = 0; i < INDIVIDUALS; i += 2) {
-                pop[i].first.symbol = 'X';
-                pop[i+1].first.symbol = 'O';
-                TicTacToeBOT game(pop[i].first, pop[i+1].first);
-                int result = game.botVSbot(print);
-                if (result == WIN) {
-                    pop[i].second += 1;
-                    pop[i+1].second -= 1;
+            for(int m = 0; m < (int)round.size(); m++) {
+                int i = round[m].first, o = round[m].second;
+                if (results[m] == WIN) {
                     winrate_table[i].first++;
-                    winrate_table[i+1].second.second++;
-                } else if (result == LOSS) {
-                    pop[i].second -= 1;
-                    pop[i + 1].second += 1;
-                    winrate_table[i + 1].first++;
+                    winrate_table[o].second.second++;
+                } else if (results[m] == LOSS) {
+                    winrate_table[o].first++;
                     winrate_table[i].second.second++;
-                } else if (result == DRAW) {
+                } else {
                     winrate_table[i].second.first++;
-                    winrate_table[i+1].second.first++;
+                    winrate_table[o].second.first++;
                 }
             }
             for (int i = 0; i < INDIVIDUALS; ++i)
             {
-                cout << "WIN/DRAW RATE BOT " << i << ": WINS: " << winrate_table[i].first << " DRAWS: " << winrate_table[i].second.first << " LOSSES: " << winrate_table[i].second.second << endl;
+                cout << "WIN/DRAW RATE BOT " << i << ": WINS: " << winrate_table[i].first << " DRAWS: " << winrate_table[i].second.first << " LOSSES: " << winrate_table[i].second.second
+                     << " RATING: " << (int)ratings[i].mu << " +- " << (int)ratings[i].sigma << endl;
             }
-            if(j % CROSSOVER_ROUNDS == 0) // Creates a new generation every defined number of rounds
+            // Creates a new generation once the leader is known, or after CROSSOVER_ROUNDS rounds at most
+            generation_rounds++;
+            bool confident = RATING_SYSTEM::confident(ratings);
+            if(confident || generation_rounds >= CROSSOVER_ROUNDS) {
+                cout << "Generation " << generation << ": " << generation_games << " games, leader "
+                     << (confident ? "confident" : "not confident yet") << endl;
                 crossover();
+                generation_rounds = 0;
+                generation_games = 0;
+            }
         }
+        cout << "Tournament: " << tournament.played << " matches played, " << tournament.reused << " results reused\n";
         if(save_load) {
             for(int i = 0; i < INDIVIDUALS; i += 2) {
+                pop[i].first.symbol = 'X';
+                pop[i+1].first.symbol = 'O';
                 string file_name = "";
                 file_name += pop[i].first.symbol;
                 file_name += i + '0' ;
                 file_name.append(".txt");
-                pop[i].first.save_genomes(file_name);
+                pop[i].first.save_genomes(file_prefix() + file_name);
                 file_name[0] = pop[i+1].first.symbol;
-                pop[i+1].first.save_genomes(file_name);
+                pop[i+1].first.save_genomes(file_prefix() + file_name);
             }
         }        
     }
 
-   void train_population_minimax(bool print = false, bool save_load = false) {
+   /**
+    * @brief Plays every individual against a search teacher, as 'X' and as 'O', for ROUNDS rounds.
+    * @param teacher the minimax (Optimal_algorithm_T) or any player with the same findBestMove interface
+    */
+   template<class TEACHER>
+   void train_against(TEACHER& teacher, bool print = false, bool save_load = false) {
     
     // (Lógica de Carregamento/Inicialização MANTIDA)
     if (save_load) {
@@ -185,7 +412,7 @@ class POPULATION {
             // Assumimos que o load não é mais estritamente atrelado ao símbolo 'X' ou 'O', 
             // mas usamos 'X' para manter a convenção de salvamento.
             string file_name = "X" + to_string(i) + ".txt";
-            pop[i].first.load_genomes(file_name); 
+            pop[i].first.load_genomes(file_prefix() + file_name); 
             pop[i].first.symbol = 'X'; // Definimos o símbolo base
         }
     } else {
@@ -194,9 +421,14 @@ class POPULATION {
         }
     }
 
-    // 1. Instancia o Minimax Player fixo
-    Optimal_algorithm fixed_minimax('O'); // O Minimax precisa de um símbolo para inicializar
-    
+    seek_individuals();
+    cout << "Seed: " << seed << endl;
+
+    // Todos os jogos são gravados no log de jogos desta variante
+    GAME_LOG_WRITER_T<ROWS, COLS, K> game_log;
+    if (save_load)
+        game_log.open(file_prefix() + "games.log");
+
     // Inicialização da Tabela para esta Rodada de ROUNDS
     vector<pair<int, pair<int, int>>> winrate_table(INDIVIDUALS, {0, {0, 0}}); 
 
@@ -206,7 +438,9 @@ class POPULATION {
         for (int i = 0; i < INDIVIDUALS; ++i) { // Iterar sobre todos os BOTs evolutivos
             
             // 2. Cria o controlador, passando o BOT por REFERÊNCIA
-            TicTacToeMiniMax game(pop[i].first, fixed_minimax); 
+            TicTacToeMiniMax_T<ROWS, COLS, K, TEACHER> game(pop[i].first, teacher); 
+            game.game_log = &game_log;
+            game.early_end = EARLY_END;
 
             // --- Jogo 1: BOT é 'X' (Primeiro a jogar) ---
             // 'true' significa que o BOT é 'X'
@@ -253,19 +487,235 @@ class POPULATION {
     
     // 4. Salvamento
     if (save_load) {
-        BEST.first.save_genomes("BEST.txt");
+        BEST.first.save_genomes(file_prefix() + "BEST.txt");
         for (int i = 0; i < INDIVIDUALS; ++i) {
             string file_name = "X" + to_string(i) + ".txt";
-            pop[i].first.save_genomes(file_name);
+            pop[i].first.save_genomes(file_prefix() + file_name);
         }
     }
+   }
+
+   void train_population_minimax(bool print = false, bool save_load = false) {
+
+    // 1. Instancia o Minimax Player fixo
+    Optimal_algorithm fixed_minimax('O'); // O Minimax precisa de um símbolo para inicializar
+    // Tabuleiros maiores não podem ser resolvidos a cada jogada: busca paralela com tempo limitado
+    if (!BOARD::CLASSIC) {
+        fixed_minimax.threads = max(1u, thread::hardware_concurrency());
+        fixed_minimax.time_budget_ms = TEACHER_TIME_MS;
+    }
+    // Posições já resolvidas em execuções anteriores (cache compartilhado por todas as instâncias)
+    if (save_load)
+        Optimal_algorithm::load_cache(file_prefix() + "minimax_cache.txt");
+    // Tabela de finais gerada pela opção 7 (mapeada, compartilhada entre processos)
+    ENDGAME_TABLE_T<ROWS, COLS, K> endgame;
+    if (save_load && endgame.open(file_prefix() + "endgame.bin"))
+        fixed_minimax.endgame = &endgame;
+    // Posições resolvidas pela opção 8 entram na tabela de transposição da busca paralela
+    if (save_load && !BOARD::CLASSIC)
+        Optimal_algorithm::load_solved(file_prefix() + "solved.txt");
+
+    train_against(fixed_minimax, print, save_load);
+
+    if (save_load)
+        Optimal_algorithm::save_cache(file_prefix() + "minimax_cache.txt");
+}
+
+   /**
+    * @brief Evolves a STEADY_STATE_T population against the minimax on every core, without
+    * generations, and keeps its best individual as BEST.
+    * @param games games to play (two per evaluation, one as 'X' and one as 'O')
+    */
+   void train_steady_state(long long games, bool save_load = false) {
+    STEADY_STATE_T<ROWS, COLS, K> steady(STEADY_INDIVIDUALS, seed);
+    steady.mutation_rate = MIN_MUT;
+    steady.mutation_step = MUTATION_STEP;
+    steady.early_end = EARLY_END;
+    if (save_load)
+        for (int i = 0; i < steady.size(); i++)
+            steady[i].bot.load_genomes(file_prefix() + "BEST.txt");
+
+    // Each worker copies this teacher; on bigger boards every copy searches on one thread
+    Optimal_algorithm teacher('O');
+    if (!BOARD::CLASSIC) {
+        teacher.threads = 1;
+        teacher.time_budget_ms = TEACHER_TIME_MS;
+    }
+    if (save_load)
+        Optimal_algorithm::load_cache(file_prefix() + "minimax_cache.txt");
+
+    steady.run(games, teacher, save_load ? file_prefix() + "games.log" : "");
+
+    int workers = steady.threads > 0 ? steady.threads : max(1u, thread::hardware_concurrency());
+    cout << "Steady state: " << games << " games on " << workers << " threads in " << steady.time_ms << " ms ("
+         << games * 1000.0 / max(steady.time_ms, 1e-3) << " games/s), " << steady.utilisation * 100 << "% busy\n";
+    cout << "Replacements: " << steady.get_replacements() << ", busy individuals skipped: " << steady.get_failed_claims() << "\n";
+    int best = steady.best();
+    cout << "Best individual " << best << ": " << steady[best].games << " games, fitness " << steady[best].fitness()
+         << ", born after " << steady[best].born << " replacements, " << steady[best].bot.genomes.size() << " states\n";
+
+    BEST.first = steady[best].bot;
+    if (save_load) {
+        BEST.first.save_genomes(file_prefix() + "BEST.txt");
+        Optimal_algorithm::save_cache(file_prefix() + "minimax_cache.txt");
+    }
+   }
+
+   /**
+    * @brief Evolves ISLANDS_T islands against the minimax, one process each, and keeps the
+    * best individual of all of them as BEST.
+    * @param islands processes to run
+    * @param games games each island plays
+    */
+   void train_islands(int islands, long long games, bool save_load = false) {
+    ISLANDS_T<ROWS, COLS, K> archipelago(islands);
+    archipelago.seed = seed;
+    archipelago.mutation_rate = MIN_MUT;
+    archipelago.mutation_step = MUTATION_STEP;
+    archipelago.early_end = EARLY_END;
+    if (save_load)
+        archipelago.seed_file = file_prefix() + "BEST.txt";
+
+    // Every island copies this teacher and searches on one thread
+    Optimal_algorithm teacher('O');
+    if (!BOARD::CLASSIC) {
+        teacher.threads = 1;
+        teacher.time_budget_ms = TEACHER_TIME_MS;
+    }
+    if (save_load)
+        Optimal_algorithm::load_cache(file_prefix() + "minimax_cache.txt");
+
+    if (!archipelago.run(games, teacher, BEST.first, save_load ? file_prefix() + "games.log" : ""))
+        return;
+
+    long long total_games = 0;
+    for (int i = 0; i < (int)archipelago.reports.size(); i++) {
+        auto& report = archipelago.reports[i];
+        total_games += report.games;
+        cout << "Island " << i << ": " << report.games << " games in " << report.time_ms << " ms, "
+             << report.replacements << " replacements, " << report.migrants_in << " migrants received, best fitness "
+             << report.fitness << " (" << report.states << " states)\n";
+    }
+    cout << "Islands: " << total_games << " games in " << archipelago.time_ms << " ms ("
+         << total_games * 1000.0 / max(archipelago.time_ms, 1e-3) << " games/s)\n";
+
+    if (save_load)
+        BEST.first.save_genomes(file_prefix() + "BEST.txt");
+   }
+
+   /**
+    * @brief Trains the population against a Monte Carlo Tree Search teacher.
+    * @param playouts playouts per move; 0 uses TEACHER_TIME_MS per move instead
+    */
+   void train_population_mcts(long long playouts, bool print = false, bool save_load = false) {
+    MCTS_T<ROWS, COLS, K> mcts('O', playouts);
+    if (playouts <= 0)
+        mcts.time_budget_ms = TEACHER_TIME_MS;
+
+    train_against(mcts, print, save_load);
+
+    cout << "MCTS: " << mcts.total_playouts << " playouts in " << mcts.total_time_ms << " ms ("
+         << (mcts.total_time_ms > 0 ? mcts.total_playouts * 1000.0 / mcts.total_time_ms : 0) << " playouts/s)\n";
 }
 
+   /**
+    * @brief Trains an n-tuple network against a search teacher, alternating 'X' and 'O'.
+    * The network is saved to (and loaded from) file_prefix() + "ntuple.txt".
+    * @param games games to play
+    * @param teacher the search teacher, the minimax or an MCTS_T
+    */
+   template<class TEACHER>
+   static void train_ntuple(int games, TEACHER& teacher, bool print = false, bool save_load = false) {
+    typedef NTUPLE_BOT_T<ROWS, COLS, K> NTUPLE_BOT;
+    NTUPLE_BOT network('X');
+    if (save_load)
+        network.load_genomes(file_prefix() + "ntuple.txt");
+    cout << "N-tuple network: " << NTUPLE_BOT::TUPLES << " tuples, " << NTUPLE_BOT::WEIGHTS << " weights ("
+         << NTUPLE_BOT::MEMORY_BYTES / 1024.0 << " KB), " << NTUPLE_BOT::TUPLES << " lookups per candidate move\n";
+
+    TicTacToeMiniMax_T<ROWS, COLS, K, TEACHER, NTUPLE_BOT> game(network, teacher);
+    int block = max(1, games / 10);
+    // Results of the block moving first [0] and second [1], so a network that only learned one side shows it
+    int wins[2] = {0, 0}, draws[2] = {0, 0}, losses[2] = {0, 0};
+    for (int g = 0; g < games; g++) {
+        int side = g % 2;
+        short result = game.run_game(side == 0, print);
+        if (result == WIN) wins[side]++;
+        else if (result == DRAW) draws[side]++;
+        else losses[side]++;
+
+        if ((g + 1) % block == 0 || g + 1 == games) {
+            cout << "Games " << g + 1 << ": WINS: " << wins[0] + wins[1] << " DRAWS: " << draws[0] + draws[1]
+                 << " LOSSES: " << losses[0] + losses[1] << " (first: " << wins[0] << "/" << draws[0] << "/" << losses[0]
+                 << ", second: " << wins[1] << "/" << draws[1] << "/" << losses[1] << ")" << endl;
+            wins[0] = wins[1] = draws[0] = draws[1] = losses[0] = losses[1] = 0;
+        }
+    }
+
+    if (save_load)
+        network.save_genomes(file_prefix() + "ntuple.txt");
+   }
+
+   /**
+    * @brief Trains an n-tuple network against the minimax (time-limited and parallel on boards bigger than 3x3).
+    */
+   static void train_ntuple_minimax(int games, bool print = false, bool save_load = false) {
+    Optimal_algorithm fixed_minimax('O');
+    if (!BOARD::CLASSIC) {
+        fixed_minimax.threads = max(1u, thread::hardware_concurrency());
+        fixed_minimax.time_budget_ms = TEACHER_TIME_MS;
+    }
+    train_ntuple(games, fixed_minimax, print, save_load);
+   }
+
+   /**
+    * @brief Trains BEST.txt offline from games.log with the given rewards and saves it to replay.txt.
+    * @param side symbol whose moves are learned, EMPTY_CELL learns both players
+    */
+   static void replay_log(float win_reward, float draw_reward, float loss_reward, char side = 'X') {
+    BOT bot(side == EMPTY_CELL ? 'X' : side);
+    bot.load_genomes(file_prefix() + "BEST.txt");
+    bot.win_reward = win_reward;
+    bot.draw_reward = draw_reward;
+    bot.loss_reward = loss_reward;
+
+    REPLAY_TRAINER_T<ROWS, COLS, K> trainer(bot, side);
+    if (!trainer.train(file_prefix() + "games.log"))
+        return;
+    cout << "Replayed " << trainer.games_replayed << " games (" << trainer.moves_replayed << " moves) on "
+         << trainer.threads << " threads in " << trainer.time_ms << " ms ("
+         << trainer.games_replayed * 1000.0 / max(trainer.time_ms, 1e-3) << " games/s), "
+         << bot.genomes.size() << " states\n";
+    bot.save_genomes(file_prefix() + "replay.txt");
+   }
+
+   /**
+    * @brief Writes the endgame table of this board, read by train_population_minimax.
+    * @param min_stones fewest stones of a solved position (0 solves the whole game)
+    */
+   static bool generate_endgame(int min_stones) {
+    return ENDGAME_TABLE_T<ROWS, COLS, K>::generate(file_prefix() + "endgame.bin", min_stones);
+   }
+
+   /**
+    * @brief Finds the value of the empty board with the proof-number solver and saves the solved positions.
+    * @param node_budget nodes the solver may expand, 0 means unlimited
+    */
+   static void solve_board(long long node_budget) {
+    PN_SOLVER_T<ROWS, COLS, K> solver;
+    solver.node_budget = node_budget;
+    int value = solver.solve(BOARD(), 'X');
+    const char* names[4] = {"unknown (node budget reached)", "first player wins", "draw", "second player wins"};
+    cout << ROWS << "x" << COLS << " (" << K << " in a row): " << names[value] << ", "
+         << solver.get_nodes() << " nodes in " << solver.get_time_ms() << " ms\n";
+    solver.save_solved(file_prefix() + "solved.txt");
+   }
+
 void train_player(bool print = false, bool save_load = false) {
     
     // (Lógica de Carregamento/Inicialização MANTIDA)
     if (save_load) {
-        BEST.first.load_genomes("BEST.txt");
+        BEST.first.load_genomes(file_prefix() + "BEST.txt");
     }
 
     TicTacToePlayer game(BEST.first);
@@ -273,11 +723,336 @@ void train_player(bool print = false, bool save_load = false) {
     
     // 4. Salvamento
     if (save_load) {
-        BEST.first.save_genomes("BEST.txt");
+        BEST.first.save_genomes(file_prefix() + "BEST.txt");
     }
 }
 };
 
+typedef POPULATION_T<3, 3, 3> POPULATION;
+
+/**
+ * @brief Writes and reads back a game log of random 3x3 games, reporting games per second.
+ * @param games games to log
+ */
+void benchmark_game_log(int games = 5000000) {
+    const string filename = "benchmark_games.log";
+    remove(filename.c_str());
+
+    // Random games are generated first, so only the log is timed
+    vector<uint8_t> moves;
+    vector<uint8_t> counts(games), results(games);
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    for(int g = 0; g < games; g++) {
+        uint8_t cells[9] = {0, 1, 2, 3, 4, 5, 6, 7, 8};
+        int count = 5 + g % 5;
+        for(int i = 0; i < count; i++) {
+            state ^= state << 13; state ^= state >> 7; state ^= state << 17;
+            swap(cells[i], cells[i + state % (9 - i)]);
+            moves.push_back(cells[i]);
+        }
+        counts[g] = count;
+        results[g] = g % 3;
+    }
+
+    auto start = chrono::steady_clock::now();
+    {
+        GAME_LOG_WRITER log;
+        log.open(filename);
+        size_t offset = 0;
+        for(int g = 0; g < games; g++) {
+            log.write(&moves[offset], counts[g], results[g], g % 2 ? 'O' : 'X');
+            offset += counts[g];
+        }
+    }
+    double write_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    start = chrono::steady_clock::now();
+    GAME_LOG_READER reader;
+    reader.open(filename);
+    GAME_RECORD game;
+    long long read = 0, total_moves = 0, checksum = 0;
+    while(reader.next(game)) {
+        read++;
+        total_moves += game.count;
+        checksum += game.moves[game.count - 1] + game.result;
+    }
+    double read_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    struct stat info;
+    stat(filename.c_str(), &info);
+    cout << "Game log: " << games << " games, " << info.st_size << " bytes (" << (double)info.st_size / games << " bytes per game)\n";
+    cout << "Write: " << write_ms << " ms (" << games / write_ms * 1000 << " games/s)\n";
+    cout << "Read: " << read << " games, " << total_moves << " moves in " << read_ms << " ms ("
+         << read / max(read_ms, 1e-3) * 1000 << " games/s, checksum " << checksum << ")\n";
+    remove(filename.c_str());
+}
+
+/**
+ * @brief Counts the heap allocations of the bot's hot paths: a game against the minimax,
+ * a copy of a trained bot (as in crossover) and a canonical form.
+ * @param games measured games, played after as many warm-up games
+ */
+void benchmark_allocations(int games = 100) {
+#ifndef COUNT_ALLOCATIONS
+    cout << "The allocations are only counted by the binary of 'make allocations' (a_allocations)\n";
+    (void)games;
+#else
+    BOT bot('X');
+    Optimal_algorithm minimax('O');
+    TicTacToeMiniMax game(bot, minimax);
+    for(int i = 0; i < games; i++)
+        game.run_game(i % 2, false);
+
+    long long start = heap_allocations;
+    for(int i = 0; i < games; i++)
+        game.run_game(i % 2, false);
+    double per_game = (double)(heap_allocations - start) / games;
+
+    start = heap_allocations;
+    for(int i = 0; i < games; i++) {
+        BOT copy('X');
+        copy = bot;
+    }
+    double per_copy = (double)(heap_allocations - start) / games;
+
+    vector<char> grid(BOARD::CELLS);
+    start = heap_allocations;
+    for(auto& [state, genome] : bot.genomes) {
+        grid.assign(state.begin(), state.end());
+        SYMMETRY::get_canonical(grid, {0, 0}, NULL, NULL);
+    }
+    double per_canonical = (double)(heap_allocations - start) / bot.genomes.size();
+
+    cout << "Bot with " << bot.genomes.size() << " states\n";
+    cout << "Allocations per game: " << per_game << "\n";
+    cout << "Allocations per bot copy: " << per_copy << "\n";
+    cout << "Allocations per canonical form: " << per_canonical << "\n";
+#endif
+}
+
+/**
+ * @brief Plays a fresh bot against the minimax with each EARLY_ mode and reports the
+ * moves per game and the games per second.
+ * @param games games per mode, alternating 'X' and 'O'
+ */
+void benchmark_early_end(int games = 20000) {
+    const char* names[3] = {"EARLY_OFF", "EARLY_DRAWS", "EARLY_FORCED"};
+    for(int mode : {EARLY_OFF, EARLY_DRAWS, EARLY_FORCED}) {
+        BOT bot('X');
+        bot.rng.seek(0, mode);
+        Optimal_algorithm minimax('O');
+        TicTacToeMiniMax game(bot, minimax);
+        game.early_end = mode;
+        int results[3] = {0, 0, 0};
+        auto start = chrono::steady_clock::now();
+        for(int g = 0; g < games; g++)
+            results[game.run_game(g % 2 == 0, false) + 1]++;
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        cout << names[mode] << ": " << (double)game.plies / games << " moves per game, "
+             << game.early_games << " games ended early, " << games * 1000.0 / max(ms, 1e-3) << " games/s "
+             << "(WINS: " << results[2] << " DRAWS: " << results[1] << " LOSSES: " << results[0] << ")\n";
+    }
+}
+
+/**
+ * @brief Compares how many games each fitness needs to find the best of 'individuals'
+ * players with hidden skills (games follow the rating model, so the truth is known):
+ * the win-minus-loss counter over random pairings for a fixed number of rounds, and
+ * the ratings with uncertainty-directed pairings until the leader is confident.
+ */
+void benchmark_rating(int trials = 200, int individuals = 16) {
+    RATING_SYSTEM system;
+    PHILOX rng(SEED);
+    normal_distribution<double> skill(RATING_MU, RATING_BETA), noise(0, RATING_BETA);
+    const int checkpoints[4] = {ROUNDS, 2 * ROUNDS, 4 * ROUNDS, 8 * ROUNDS};
+    int counter_correct[4] = {0, 0, 0, 0};
+    int rated_correct = 0, rated_confident = 0;
+    long long rated_games = 0;
+
+    for(int trial = 0; trial < trials; trial++) {
+        rng.seek(trial, PHILOX_POPULATION);
+        vector<double> skills(individuals);
+        for(double& s : skills)
+            s = skill(rng);
+        int truth = max_element(skills.begin(), skills.end()) - skills.begin();
+        auto play = [&](int a, int b) -> short {
+            double difference = skills[a] + noise(rng) - skills[b] - noise(rng);
+            return fabs(difference) <= system.get_margin() ? DRAW : difference > 0 ? WIN : LOSS;
+        };
+
+        // Counter: shuffled neighbours, +1 / -1, ties broken at random
+        vector<int> counter(individuals, 0), order(individuals);
+        iota(order.begin(), order.end(), 0);
+        for(int round = 1, c = 0; c < 4; round++) {
+            shuffle(order.begin(), order.end(), rng);
+            for(int i = 0; i + 1 < individuals; i += 2) {
+                short result = play(order[i], order[i + 1]);
+                counter[order[i]] += result;
+                counter[order[i + 1]] -= result;
+            }
+            if(round == checkpoints[c]) {
+                int leader = order[0];
+                for(int i : order)
+                    if(counter[i] > counter[leader])
+                        leader = i;
+                counter_correct[c++] += leader == truth;
+            }
+        }
+
+        // Ratings: the scheduler pairs the least known individuals until the leader is confident
+        vector<RATING> ratings(individuals);
+        vector<uint64_t> versions(individuals);
+        iota(versions.begin(), versions.end(), 0);
+        TOURNAMENT tournament(TOURNAMENT_UNCERTAIN);
+        for(int round = 0; round < checkpoints[3] && !RATING_SYSTEM::confident(ratings); round++) {
+            vector<int> scores(individuals);
+            for(int i = 0; i < individuals; i++)
+                scores[i] = ratings[i].conservative();
+            for(const MATCH& match : tournament.pair_round(scores, versions, round, &ratings)) {
+                system.update(ratings[match.first], ratings[match.second], play(match.first, match.second));
+                rated_games++;
+            }
+        }
+        int leader = 0;
+        for(int i = 1; i < individuals; i++)
+            if(ratings[i].mu > ratings[leader].mu)
+                leader = i;
+        rated_correct += leader == truth;
+        rated_confident += RATING_SYSTEM::confident(ratings);
+    }
+
+    cout << individuals << " individuals, " << trials << " trials, " << system.get_margin() << " draw margin\n";
+    for(int c = 0; c < 4; c++)
+        cout << "Counter, " << checkpoints[c] << " rounds: " << checkpoints[c] * (individuals / 2) << " games, best found in "
+             << 100.0 * counter_correct[c] / trials << "% of the trials\n";
+    cout << "Ratings until confident: " << (double)rated_games / trials << " games on average, best found in "
+         << 100.0 * rated_correct / trials << "% of the trials (" << 100.0 * rated_confident / trials << "% confident before "
+         << checkpoints[3] << " rounds)\n";
+}
+
+/**
+ * @brief Compares the plain minimax against the alpha-beta search from the empty board.
+ */
+void benchmark_minimax(void) {
+    BOARD board;
+    Optimal_algorithm plain('X', false, false), pruned('X', true, false);
+    Optimal_algorithm::SearchStats plain_stats, pruned_stats;
+
+    plain.findBestMove(board, 'X', 'O', &plain_stats);
+    pruned.findBestMove(board, 'X', 'O', &pruned_stats);
+
+    cout << "Minimax:    " << plain_stats.nodes << " nodes, " << plain_stats.time_ms << " ms\n";
+    cout << "Alpha-beta: " << pruned_stats.nodes << " nodes, " << pruned_stats.time_ms << " ms\n";
+}
+
+/**
+ * @brief Times the hot paths of the engine on the 3x3 board and on the 4x4x4 cube:
+ * win checks, canonical forms, genome lookups and search.
+ * @param games random games (stopped at a random move) used by the per-operation timings
+ */
+void benchmark_qubic(int games = 20000) {
+    mt19937 rng(12345);
+    auto since = [](chrono::steady_clock::time_point start) {
+        return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    };
+    auto rate = [](long long ops, double ms) {
+        return ms > 0 ? ops / ms / 1000.0 : 0.0;
+    };
+
+    // Random move sequences of both boards
+    vector<vector<short>> small_moves(games), cube_moves(games);
+    vector<BOARD> small(games);
+    vector<QUBIC_BOARD> cube(games);
+    for(int g = 0; g < games; g++) {
+        for(int i = (int)(rng() % 8); i > 0 && small[g].get_winner() == EMPTY_CELL; i--) {
+            short cell;
+            do cell = rng() % 9; while(small[g].grid[cell] != EMPTY_CELL);
+            small[g].do_move(small_moves[g].size() % 2 ? 'O' : 'X', cell);
+            small_moves[g].push_back(cell);
+        }
+        for(int i = (int)(rng() % 40); i > 0 && cube[g].get_winner() == EMPTY_CELL; i--) {
+            short cell;
+            do cell = rng() % 64; while(cube[g].get_cell(cell) != EMPTY_CELL);
+            cube[g].do_move(cube_moves[g].size() % 2 ? 'O' : 'X', cell);
+            cube_moves[g].push_back(cell);
+        }
+    }
+
+    cout << "Operation (M ops/s)   3x3        4x4x4\n";
+
+    // Win checks: every game is replayed with a check after each move
+    long long small_ops = 0, cube_ops = 0, small_wins = 0, cube_wins = 0;
+    BOARD small_board;
+    QUBIC_BOARD cube_board;
+    auto start = chrono::steady_clock::now();
+    for(int g = 0; g < games; g++) {
+        small_board.reset_board();
+        for(size_t i = 0; i < small_moves[g].size(); i++, small_ops++) {
+            short cell = small_moves[g][i];
+            small_board.make_move(i % 2 ? 'O' : 'X', cell / 3, cell % 3);
+            small_wins += small_board.check_win(cell / 3, cell % 3);
+        }
+    }
+    double small_ms = since(start);
+    start = chrono::steady_clock::now();
+    for(int g = 0; g < games; g++) {
+        cube_board.reset_board();
+        for(size_t i = 0; i < cube_moves[g].size(); i++, cube_ops++) {
+            short cell = cube_moves[g][i];
+            cube_board.make_move(i % 2 ? 'O' : 'X', cell / 16, cell / 4 % 4, cell % 4);
+            cube_wins += cube_board.check_win(cell / 16, cell / 4 % 4, cell % 4);
+        }
+    }
+    cout << "make_move+check_win   " << rate(small_ops, small_ms) << "   " << rate(cube_ops, since(start))
+         << " (" << small_wins << " and " << cube_wins << " wins found)\n";
+
+    // Canonical forms: 8 transforms of 9 cells against 48 transforms of 64 cells
+    start = chrono::steady_clock::now();
+    for(int g = 0; g < games; g++)
+        SYMMETRY::get_canonical(small[g].grid, {0, 0}, NULL, NULL);
+    small_ms = since(start);
+    start = chrono::steady_clock::now();
+    for(int g = 0; g < games; g++)
+        QUBIC_BOARD::get_canonical_grid(cube[g].get_grid());
+    cout << "get_canonical (grid)  " << rate(games, small_ms) << "   " << rate(games, since(start)) << "\n";
+    start = chrono::steady_clock::now();
+    for(int g = 0; g < games; g++)
+        cube[g].get_canonical();
+    cout << "get_canonical (bits)  -   " << rate(games, since(start)) << "\n";
+
+    // Genome lookups in maps keyed by the canonical grid, as in BOT_T
+    map<vector<char>, vector<long long>> small_genomes, cube_genomes;
+    for(int g = 0; g < games; g++) {
+        small_genomes[SYMMETRY::get_canonical(small[g].grid, {0, 0}, NULL, NULL).first].assign(9, 1);
+        cube_genomes[QUBIC_BOARD::get_canonical_grid(cube[g].get_grid())].assign(64, 1);
+    }
+    long long small_found = 0, cube_found = 0;
+    start = chrono::steady_clock::now();
+    for(int g = 0; g < games; g++)
+        small_found += small_genomes.count(SYMMETRY::get_canonical(small[g].grid, {0, 0}, NULL, NULL).first);
+    small_ms = since(start);
+    start = chrono::steady_clock::now();
+    for(int g = 0; g < games; g++)
+        cube_found += cube_genomes.count(QUBIC_BOARD::get_canonical_grid(cube[g].get_grid()));
+    cout << "genome lookup         " << rate(games, small_ms) << "   " << rate(games, since(start))
+         << " (" << small_found << " and " << cube_found << " of " << games << " found)\n";
+    cout << "distinct positions    " << small_genomes.size() << "   " << cube_genomes.size() << " of " << games
+         << " games (" << cube_genomes.size() * (64 + 64 * sizeof(long long)) / 1024 << " KB of cube genomes)\n";
+
+    // Search from the empty board
+    BOARD empty;
+    Optimal_algorithm solver('X', true, false);
+    Optimal_algorithm::SearchStats small_stats;
+    solver.findBestMove(empty, 'X', 'O', &small_stats);
+    QUBIC_BOARD empty_cube;
+    QUBIC_SEARCH search(64, 1000);
+    QUBIC_SEARCH::SearchStats cube_stats;
+    search.findBestMove(empty_cube, 'X', &cube_stats);
+    cout << "search                3x3 solved in " << small_stats.nodes << " nodes (" << small_stats.time_ms
+         << " ms), 4x4x4 reached depth " << cube_stats.depth << " of 64 in " << cube_stats.time_ms << " ms ("
+         << rate(cube_stats.nodes, cube_stats.time_ms) << " M nodes/s)\n";
+}
+
 int main(void) {
     POPULATION p;
 
@@ -286,6 +1061,24 @@ int main(void) {
     cout << "------------ MENU -------------\n";
     cout << "Choose 1 to train the population\n";
     cout << "Choose 2 to play against the bot BOT\n";
+    cout << "Choose 3 to benchmark the minimax search\n";
+    cout << "Choose 4 to train a 4x4 population (4 in a row)\n";
+    cout << "Choose 5 to train a 5x5 population (4 in a row)\n";
+    cout << "Choose 6 to train the population against a Monte Carlo Tree Search bot\n";
+    cout << "Choose 7 to generate an endgame table\n";
+    cout << "Choose 8 to solve a board with proof-number search\n";
+    cout << "Choose 9 for ultimate tic tac toe\n";
+    cout << "Choose 10 for 4x4x4 tic tac toe (Qubic)\n";
+    cout << "Choose 11 to train an n-tuple network against the minimax\n";
+    cout << "Choose 12 to enumerate every 3x3 game and write the labeled dataset\n";
+    cout << "Choose 13 to benchmark the game log\n";
+    cout << "Choose 14 to train a bot offline from the game log\n";
+    cout << "Choose 15 to benchmark the batch canonical forms\n";
+    cout << "Choose 16 to count the heap allocations of the bot\n";
+    cout << "Choose 17 to evolve a steady-state population against the minimax on every core\n";
+    cout << "Choose 18 to evolve islands of bots in separate processes\n";
+    cout << "Choose 19 to benchmark ending the games early\n";
+    cout << "Choose 20 to compare the games the ratings and the win counter need to find the best\n";
     cin >> opc;
 
     switch (opc)
@@ -297,7 +1090,180 @@ int main(void) {
     case 2:
         p.train_player(true, true);
         break;
+
+    case 3:
+        benchmark_minimax();
+        break;
+
+    case 4: {
+        POPULATION_T<4, 4, 4> p4;
+        cout << "Choose 1 for bot vs bot or 2 for bot vs parallel minimax\n";
+        cin >> opc;
+        if(opc == 2)
+            p4.train_population_minimax(false, true);
+        else
+            p4.train_population(false, true);
+        break;
+    }
+
+    case 5: {
+        POPULATION_T<5, 5, 4> p5;
+        cout << "Choose 1 for bot vs bot or 2 for bot vs parallel minimax\n";
+        cin >> opc;
+        if(opc == 2)
+            p5.train_population_minimax(false, true);
+        else
+            p5.train_population(false, true);
+        break;
+    }
+
+    case 6: {
+        long long playouts;
+        cout << "Choose the playouts per move (0 for " << TEACHER_TIME_MS << " ms per move)\n";
+        cin >> playouts;
+        p.train_population_mcts(playouts, false, true);
+        break;
+    }
+
+    case 7: {
+        int size, min_stones;
+        cout << "Choose the board: 3 for 3x3, 4 for 4x4 or 5 for 5x5\n";
+        cin >> size;
+        cout << "Choose the fewest stones of a solved position (0 solves the whole game)\n";
+        cin >> min_stones;
+        if(size == 4)
+            POPULATION_T<4, 4, 4>::generate_endgame(min_stones);
+        else if(size == 5)
+            POPULATION_T<5, 5, 4>::generate_endgame(min_stones);
+        else
+            POPULATION::generate_endgame(min_stones);
+        break;
+    }
+
+    case 8: {
+        int size;
+        long long node_budget;
+        cout << "Choose the board: 3 for 3x3, 4 for 4x4 or 5 for 5x5\n";
+        cin >> size;
+        cout << "Choose the node budget (0 for unlimited)\n";
+        cin >> node_budget;
+        if(size == 4)
+            POPULATION_T<4, 4, 4>::solve_board(node_budget);
+        else if(size == 5)
+            POPULATION_T<5, 5, 4>::solve_board(node_budget);
+        else
+            POPULATION::solve_board(node_budget);
+        break;
+    }
+
+    case 9: {
+        ULTIMATE_SEARCH search;
+        cout << "Choose 1 to play against the search, 2 to watch search vs search or 3 for the move generation benchmark\n";
+        cin >> opc;
+        if(opc == 1) {
+            TicTacToeUltimate game(NULL, &search);
+            game.run_game(true);
+        }
+        else if(opc == 2) {
+            ULTIMATE_SEARCH other(ULTIMATE_MAX_DEPTH, 50);
+            TicTacToeUltimate game(&search, &other);
+            game.run_game(true);
+        }
+        else
+            benchmark_ultimate();
+        break;
+    }
+
+    case 10: {
+        QUBIC_SEARCH search;
+        cout << "Choose 1 to play against the search or 2 for the scaling benchmark\n";
+        cin >> opc;
+        if(opc == 1) {
+            TicTacToeQubic game(NULL, &search);
+            game.run_game(true);
+        }
+        else
+            benchmark_qubic();
+        break;
+    }
     
+    case 11: {
+        int size, games;
+        cout << "Choose the board: 3 for 3x3, 4 for 4x4 or 5 for 5x5\n";
+        cin >> size;
+        cout << "Choose the number of games\n";
+        cin >> games;
+        if(size == 4)
+            POPULATION_T<4, 4, 4>::train_ntuple_minimax(games, false, true);
+        else if(size == 5)
+            POPULATION_T<5, 5, 4>::train_ntuple_minimax(games, false, true);
+        else
+            POPULATION::train_ntuple_minimax(games, false, true);
+        break;
+    }
+
+    case 12: {
+        ENUMERATOR enumerator;
+        const char* names[3] = {"second player wins", "draw", "first player wins"};
+        int value = enumerator.run("dataset.bin");
+        cout << "Games: " << enumerator.games << " (" << enumerator.first_wins << " won by the first player, "
+             << enumerator.second_wins << " by the second, "
+             << enumerator.games - enumerator.first_wins - enumerator.second_wins << " draws)\n";
+        cout << "Empty board: " << names[value + 1] << "\n";
+        cout << "Positions written to dataset.bin (up to symmetry): " << enumerator.get_records() << "\n";
+        cout << "Nodes: " << enumerator.nodes << " in " << enumerator.time_ms << " ms ("
+             << enumerator.nodes * 1000.0 / max(enumerator.time_ms, 1e-3) << " positions/s, "
+             << enumerator.steals << " tasks stolen)\n";
+        break;
+    }
+
+    case 13:
+        benchmark_game_log();
+        break;
+
+    case 14: {
+        float win_reward, draw_reward, loss_reward;
+        cout << "Choose the rewards of a win, a draw and a loss (the online ones are 0.2 0.1 -0.05)\n";
+        cin >> win_reward >> draw_reward >> loss_reward;
+        POPULATION::replay_log(win_reward, draw_reward, loss_reward);
+        break;
+    }
+
+    case 15:
+        benchmark_canonical();
+        break;
+
+    case 16:
+        benchmark_allocations();
+        break;
+
+    case 17: {
+        long long games;
+        cout << "Choose the number of games\n";
+        cin >> games;
+        p.train_steady_state(games, true);
+        break;
+    }
+
+    case 18: {
+        int islands;
+        long long games;
+        cout << "Choose the number of islands (processes)\n";
+        cin >> islands;
+        cout << "Choose the number of games of each island\n";
+        cin >> games;
+        p.train_islands(islands, games, true);
+        break;
+    }
+
+    case 19:
+        benchmark_early_end();
+        break;
+
+    case 20:
+        benchmark_rating();
+        break;
+
     default:
         break;
     }